@@ -0,0 +1,204 @@
+// Card-abstraction benchmark.
+//
+// Usage: abstraction_bench [output-path]   (default: bench_output.txt)
+//
+// Times the nearest-centroid kernel and k-means at thread counts from 1 to
+// the hardware concurrency (assignments must agree), enumerates the
+// canonical flop hands, builds a reduced preflop+flop bucket map, and then
+// measures how long opening the map takes and how fast lookups run. Every
+// lookup is repeated under a random suit relabeling, which must give the
+// same bucket. A flop spot is then solved over the map's buckets with
+// makeBucketedGame(), and bucket bots play a short self-play run from the
+// map. The scratch map is removed afterwards. Exits with status 1 if the
+// thread counts disagree, a relabeled lookup changes bucket, the bucketed
+// solve stays above 1% of the pot exploitable or a bot acts illegally.
+
+#include "bench_util.hpp"
+#include "poker/abstraction.hpp"
+#include "poker/cfr.hpp"
+#include "poker/isomorphism.hpp"
+#include "poker/kmeans.hpp"
+#include "poker/rng.hpp"
+#include "poker/simulator.hpp"
+#include "poker/thread_pool.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace poker;
+
+namespace {
+
+const char* const kScratch = "abstraction_bench.pkb";
+
+bool benchKMeans(FILE* out) {
+    const size_t points = 200'000;
+    const int dims = 16;
+    const int stride = kMeansStride(dims);
+    Rng rng(7);
+    std::vector<float> data(points * stride, 0.0f);
+    for (size_t i = 0; i < points; ++i) {
+        // Noisy cumulative histograms, like the abstraction's features.
+        float running = 0;
+        for (int d = 0; d < dims; ++d) {
+            running += static_cast<float>(rng.uniform());
+            data[i * stride + d] = running;
+        }
+        for (int d = 0; d < dims; ++d) data[i * stride + d] /= running;
+    }
+
+    const int k = 64;
+    std::vector<uint32_t> nearest(points);
+    std::vector<float> distance(points);
+    auto start = std::chrono::steady_clock::now();
+    nearestCentroids(data.data(), points, data.data(), k, stride, nearest.data(), distance.data());
+    double seconds = bench::secondsSince(start);
+    for (FILE* f : {out, stdout}) {
+        std::fprintf(f, "bench=kmeans_nearest items=%zu seconds=%.6f distances_per_sec=%.0f avx2=%d\n",
+                     points, seconds, points * double(k) / seconds, kMeansUsesAvx2());
+    }
+
+    unsigned hardware = std::thread::hardware_concurrency();
+    if (hardware == 0) hardware = 1;
+    std::vector<uint32_t> reference;
+    bool consistent = true;
+    for (unsigned threads = 1; threads <= hardware; threads *= 2) {
+        ThreadPool pool(threads);
+        KMeansOptions options;
+        options.clusters = k;
+        options.maxIterations = 10;
+        options.pool = &pool;
+        start = std::chrono::steady_clock::now();
+        const KMeansResult result = kMeans(data.data(), points, stride, options);
+        seconds = bench::secondsSince(start);
+        if (reference.empty()) reference = result.assignment;
+        consistent = consistent && result.assignment == reference;
+        for (FILE* f : {out, stdout}) {
+            std::fprintf(f,
+                         "bench=kmeans_%ut items=%zu seconds=%.6f iterations=%d inertia=%.6f\n",
+                         threads, points, seconds, result.iterations, result.inertia);
+        }
+        if (threads < hardware && threads * 2 > hardware) threads = hardware / 2;
+    }
+    for (FILE* f : {out, stdout}) std::fprintf(f, "bench=kmeans_consistency threads_agree=%d\n", consistent);
+    return consistent;
+}
+
+bool benchAbstraction(FILE* out) {
+    auto start = std::chrono::steady_clock::now();
+    const size_t flopHands = canonicalHands(Street::Flop).size();
+    bench::printResult(out, {"canonical_flop_hands", flopHands, bench::secondsSince(start), flopHands});
+    bench::printResult(stdout, {"canonical_flop_hands", flopHands, bench::secondsSince(start), flopHands});
+
+    AbstractionConfig config;
+    config.streets[0] = {true, 169, 16, 128, 0, 1'000'000, 25};
+    config.streets[1] = {true, 64, 16, 4, 8, 50'000, 8};
+    config.streets[2].enabled = false;
+    config.streets[3].enabled = false;
+    start = std::chrono::steady_clock::now();
+    const AbstractionReport report = buildAbstraction(config, kScratch);
+    const double buildSeconds = bench::secondsSince(start);
+    for (FILE* f : {out, stdout}) {
+        std::fprintf(f,
+                     "bench=abstraction_build seconds=%.6f preflop_buckets=%d flop_hands=%zu "
+                     "flop_buckets=%d flop_iterations=%d file_bytes=%zu\n",
+                     buildSeconds, report.streets[0].buckets, report.streets[1].hands,
+                     report.streets[1].buckets, report.streets[1].iterations, report.fileBytes);
+    }
+
+    start = std::chrono::steady_clock::now();
+    BucketMap map(kScratch);
+    const double openSeconds = bench::secondsSince(start);
+
+    const uint64_t lookups = 2'000'000;
+    std::vector<CardSet> holes(lookups), boards(lookups);
+    Rng rng(11);
+    for (uint64_t i = 0; i < lookups; ++i) {
+        CardSet used;
+        for (int c = 0; c < 5; ++c) {
+            Card card;
+            do card = Card(static_cast<uint8_t>(rng.below(kNumCards))); while (used.contains(card));
+            used.add(card);
+            (c < 2 ? holes[i] : boards[i]).add(card);
+        }
+    }
+    uint64_t checksum = 0;
+    start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < lookups; ++i) checksum += static_cast<uint64_t>(map.bucket(holes[i], boards[i]));
+    const double lookupSeconds = bench::secondsSince(start);
+
+    bool isomorphic = true;
+    for (uint64_t i = 0; i < lookups; i += 97) {
+        const SuitPermutation& p = suitPermutation(static_cast<int>(rng.below(kNumSuitPermutations)));
+        isomorphic = isomorphic && map.bucket(p.apply(holes[i]), p.apply(boards[i])) ==
+                                       map.bucket(holes[i], boards[i]) &&
+                     map.bucket(holes[i], CardSet()) == map.bucket(p.apply(holes[i]), CardSet());
+    }
+    for (FILE* f : {out, stdout}) {
+        std::fprintf(f, "bench=bucket_map_open seconds=%.6f file_bytes=%zu\n", openSeconds, map.fileBytes());
+        std::fprintf(f, "bench=bucket_map_lookup items=%llu seconds=%.6f rate_per_sec=%.0f checksum=%llu\n",
+                     static_cast<unsigned long long>(lookups), lookupSeconds, lookups / lookupSeconds,
+                     static_cast<unsigned long long>(checksum));
+        std::fprintf(f, "bench=bucket_map_consistency isomorphic_agree=%d\n", isomorphic);
+    }
+
+    // A flop spot solved over the map's buckets instead of the ranges' combos.
+    Range oop, ip;
+    parseRange("TT+,AJs+,KQs,AQo+,JTs,T9s,98s,76s,65s,A5s-A2s,KJo,QJo:0.5", oop);
+    parseRange("99-22,ATs+,KTs+,QTs+,J9s+,T9s,98s,AJo+,KJo+,QJo,A5s:0.5", ip);
+    CardSet flop;
+    parseCardSet("Qs8h5d", flop);
+    BettingConfig betting;
+    start = std::chrono::steady_clock::now();
+    const AbstractGame game = makeBucketedGame(oop, ip, flop, map, betting);
+    const double gameSeconds = bench::secondsSince(start);
+    const int iterations = 500;
+    CfrSolver solver(game);
+    start = std::chrono::steady_clock::now();
+    solver.iterate(iterations);
+    const double solveSeconds = bench::secondsSince(start);
+    const double exploitability = solver.exploitability() / betting.pot;
+    const bool solved = exploitability < 0.01;
+    for (FILE* f : {out, stdout}) {
+        std::fprintf(f,
+                     "bench=bucketed_flop_solve items=%d seconds=%.6f build_seconds=%.6f hands=%dx%d "
+                     "memory_bytes=%zu exploitability_pot=%.6f\n",
+                     iterations, solveSeconds, gameSeconds, game.hands[0], game.hands[1],
+                     solver.memoryBytes(), exploitability);
+    }
+
+    // Bucket bots in the even seats against the chart they fall back to on
+    // the turn and river, which this map does not cover.
+    SimulationConfig sim;
+    sim.tables = 8;
+    sim.handsPerTable = 2'000;
+    sim.threads = 1;
+    const SimulationReport played = runSimulation(sim, [&map](int seat) {
+        return seat % 2 == 0 ? makeBucketBot(map) : makeTightAggressiveBot();
+    });
+    Chips bucketNet = 0;
+    for (int seat = 0; seat < sim.table.seats; seat += 2) bucketNet += played.net[seat];
+    for (FILE* f : {out, stdout}) {
+        std::fprintf(f,
+                     "bench=bucket_bot items=%llu seconds=%.6f rate_per_sec=%.0f bucket_net=%lld "
+                     "illegal_actions=%llu\n",
+                     static_cast<unsigned long long>(played.hands), played.seconds,
+                     played.handsPerSecond(), static_cast<long long>(bucketNet),
+                     static_cast<unsigned long long>(played.illegalActions));
+    }
+    std::remove(kScratch);
+    return isomorphic && solved && played.illegalActions == 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    FILE* out = bench::openOutput(argc, argv);
+    if (!out) return 1;
+    const bool kmeansOk = benchKMeans(out);
+    const bool mapOk = benchAbstraction(out);
+    std::fclose(out);
+    return kmeansOk && mapOk ? 0 : 1;
+}
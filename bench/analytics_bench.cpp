@@ -0,0 +1,96 @@
+// Hand-history analytics benchmark.
+//
+// Usage: analytics_bench [output-path]   (default: bench_output.txt)
+//
+// Logs about a million fixed-seed self-play hands to a scratch history file,
+// computes per-player statistics over it from scratch at thread counts from 1
+// to the hardware concurrency, and then times an incremental update after a
+// small batch of new hands is appended. Every full scan must agree exactly.
+
+#include "bench_util.hpp"
+#include "poker/analytics.hpp"
+#include "poker/simulator.hpp"
+#include "poker/thread_pool.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+using namespace poker;
+
+namespace {
+
+const char* const kScratch = "analytics_bench.phh";
+
+std::unique_ptr<Bot> mixedBots(int seat) {
+    switch (seat % 3) {
+    case 0: return makeTightAggressiveBot();
+    case 1: return makeCallingStationBot();
+    default: return makeRandomBot();
+    }
+}
+
+void logHands(int tables, uint64_t handsPerTable, uint64_t seed) {
+    SimulationConfig config;
+    config.tables = tables;
+    config.handsPerTable = handsPerTable;
+    config.threads = 1;
+    config.seed = seed;
+    config.historyPath = kScratch;
+    runSimulation(config, mixedBots);
+}
+
+uint64_t checksum(const HandStats& stats) {
+    uint64_t sum = stats.hands();
+    for (const auto& [id, p] : stats.players()) {
+        sum = sum * 31 + id + p.vpip + 3 * p.pfr + 5 * p.bets + 7 * p.calls + 11 * p.showdownWins +
+              static_cast<uint64_t>(p.net);
+    }
+    return sum;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    FILE* out = bench::openOutput(argc, argv);
+    if (!out) return 1;
+    initEvaluator();
+    const std::string path = std::string(kScratch) + ".0";
+    std::remove(path.c_str());
+    logHands(64, 16'000, 1);
+
+    unsigned hardware = std::thread::hardware_concurrency();
+    if (hardware == 0) hardware = 1;
+    uint64_t reference = 0;
+    bool consistent = true;
+    for (unsigned threads = 1; threads <= hardware; threads *= 2) {
+        ThreadPool pool(threads);
+        StatsPipeline pipeline(seatKey, &pool);
+        const auto start = std::chrono::steady_clock::now();
+        const uint64_t hands = pipeline.update(path);
+        const double seconds = bench::secondsSince(start);
+        const uint64_t sum = checksum(pipeline.stats());
+        if (threads == 1) reference = sum;
+        consistent = consistent && sum == reference;
+        const std::string name = "analytics_full_" + std::to_string(threads) + "t";
+        for (FILE* f : {out, stdout}) bench::printResult(f, {name.c_str(), hands, seconds, sum});
+        if (threads < hardware && threads * 2 > hardware) threads = hardware / 2;
+    }
+
+    // Incremental: consume the archive, append ~1% more hands, update again.
+    StatsPipeline pipeline(seatKey);
+    pipeline.update(path);
+    logHands(8, 1'000, 2);
+    const auto start = std::chrono::steady_clock::now();
+    const uint64_t added = pipeline.update(path);
+    const double seconds = bench::secondsSince(start);
+    for (FILE* f : {out, stdout}) {
+        bench::printResult(f, {"analytics_incremental", added, seconds, checksum(pipeline.stats())});
+        std::fprintf(f, "bench=analytics_consistency threads_agree=%d\n", consistent ? 1 : 0);
+    }
+
+    std::remove(path.c_str());
+    std::fclose(out);
+    return consistent ? 0 : 1;
+}
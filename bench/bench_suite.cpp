@@ -0,0 +1,372 @@
+// Regression benchmark suite.
+//
+// Usage: bench_suite [output-path] [key=value...]   (default: bench_output.txt)
+//
+//   repeat=N        runs per case; the fastest is reported (default 3)
+//   threads=N       pool size for equity, self-play and CFR (default 1)
+//   filter=TEXT     only cases whose name contains TEXT
+//   baseline=PATH   compare against an earlier output of this suite
+//   tolerance=F     allowed rate drop against the baseline (default 0.15)
+//
+// Runs one fixed-seed case per hot path: evaluations, Monte Carlo and exact
+// equity trials, engine and self-play hands, and CFR+ iterations, plus the
+// Omaha evaluator, equity and engine paths (poker/variant.hpp). Every case
+// is deterministic, so its checksum must be the same on every run, thread
+// count and machine; a changed checksum means a change altered results, not
+// just speed. Output is one `bench=` line per case in the format of the other
+// benchmarks. With a baseline, each case also gets a `compare=` line, and the
+// suite exits 1 if any rate fell by more than the tolerance or any checksum
+// differs. When the library is built with POKER_ENABLE_PROFILING, each case
+// is followed by its per-phase timers and counters.
+
+#include "bench_util.hpp"
+#include "poker/cfr.hpp"
+#include "poker/equity.hpp"
+#include "poker/evaluator.hpp"
+#include "poker/profile.hpp"
+#include "poker/rng.hpp"
+#include "poker/simulator.hpp"
+#include "poker/table.hpp"
+#include "poker/thread_pool.hpp"
+#include "poker/variant.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace poker;
+
+namespace {
+
+struct Options {
+    std::string output = "bench_output.txt";
+    std::string baseline;
+    std::string filter;
+    double tolerance = 0.15;
+    int repeat = 3;
+    unsigned threads = 1;
+};
+
+/// What one run of a case did; the harness times it.
+struct Work {
+    uint64_t items;
+    uint64_t checksum;
+};
+
+struct Case {
+    const char* name;
+    std::function<Work()> run;
+};
+
+bool parseArgs(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const char* eq = std::strchr(argv[i], '=');
+        if (!eq) {
+            options.output = argv[i];
+            continue;
+        }
+        const std::string key(argv[i], eq - argv[i]);
+        const char* value = eq + 1;
+        if (key == "baseline") {
+            options.baseline = value;
+        } else if (key == "filter") {
+            options.filter = value;
+        } else if (key == "tolerance") {
+            options.tolerance = std::atof(value);
+        } else if (key == "repeat") {
+            options.repeat = std::max(1, std::atoi(value));
+        } else if (key == "threads") {
+            options.threads = static_cast<unsigned>(std::max(1, std::atoi(value)));
+        } else {
+            std::fprintf(stderr, "bench_suite: unknown option %s\n", key.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<CardSet> randomSets(size_t count, int cards, uint64_t seed) {
+    Rng rng(seed);
+    std::vector<CardSet> sets(count);
+    for (CardSet& set : sets) {
+        while (set.size() < cards) set.add(Card(static_cast<uint8_t>(rng.below(kNumCards))));
+    }
+    return sets;
+}
+
+// Disjoint four-card Omaha hands and five-card boards, interleaved.
+std::vector<CardSet> randomOmahaDeals(size_t count, uint64_t seed) {
+    Rng rng(seed);
+    std::vector<CardSet> sets(2 * count);
+    for (size_t i = 0; i < count; ++i) {
+        CardSet used;
+        for (int part = 0; part < 2; ++part) {
+            CardSet& set = sets[2 * i + part];
+            while (set.size() < (part == 0 ? 4 : 5)) {
+                const Card card(static_cast<uint8_t>(rng.below(kNumCards)));
+                if (used.contains(card)) continue;
+                used.add(card);
+                set.add(card);
+            }
+        }
+    }
+    return sets;
+}
+
+Range range(const char* text) {
+    Range r;
+    parseRange(text, r);
+    return r;
+}
+
+CardSet cards(const char* text) {
+    CardSet set;
+    parseCardSet(text, set);
+    return set;
+}
+
+// Equity rounded to 1e-9, so the checksum shows any change in the answer.
+uint64_t equityChecksum(const EquityResult& r) {
+    return r.trials * 1'000'003 + static_cast<uint64_t>(r.equity * 1e9 + 0.5);
+}
+
+Action randomAction(const LegalActions& legal, Rng& rng) {
+    const uint32_t roll = rng.below(100);
+    if (roll < 15 && !legal.canCheck) return Action::fold();
+    if (roll < 80 || !legal.canRaise) return legal.canCheck ? Action::check() : Action::call();
+    const Chips span = legal.maxRaiseTo - legal.minRaiseTo;
+    const Chips extra = span > 0 ? rng.below(static_cast<uint32_t>(span) + 1) : 0;
+    return Action::raiseTo(legal.minRaiseTo + extra);
+}
+
+template <class Variant>
+Work playTable(uint64_t hands, uint64_t seed) {
+    TableConfig config;
+    config.seats = 6;
+    BasicTable<Variant> table(config);
+    Rng rng(seed);
+    uint64_t checksum = 0;
+    for (uint64_t h = 0; h < hands; ++h) {
+        for (int s = 0; s < 6; ++s) table.seatPlayer(s, 200);
+        table.startHand(rng);
+        while (table.handInProgress()) table.act(randomAction(table.legalActions(), rng));
+        checksum += static_cast<uint64_t>(table.state().totalPot());
+    }
+    return Work{hands, checksum};
+}
+
+std::unique_ptr<Bot> mixedBots(int seat) {
+    switch (seat % 3) {
+    case 0: return makeTightAggressiveBot();
+    case 1: return makeCallingStationBot();
+    default: return makeRandomBot();
+    }
+}
+
+std::vector<Case> makeCases(ThreadPool& pool) {
+    std::vector<Case> cases;
+
+    cases.push_back({"suite_eval7_set", [] {
+        static const std::vector<CardSet> sets = randomSets(1 << 20, 7, 0x5e7e0007u);
+        uint64_t checksum = 0;
+        for (int pass = 0; pass < 64; ++pass) {
+            for (CardSet set : sets) checksum += evaluate(set);
+        }
+        return Work{sets.size() * 64, checksum};
+    }});
+
+    cases.push_back({"suite_eval7_batch", [] {
+        static const std::vector<CardSet> sets = randomSets(1 << 20, 7, 0x5e7e0007u);
+        static std::vector<HandValue> values(sets.size());
+        uint64_t checksum = 0;
+        for (int pass = 0; pass < 64; ++pass) {
+            evaluateBatch(sets.data(), values.data(), sets.size());
+            for (HandValue v : values) checksum += v;
+        }
+        return Work{sets.size() * 64, checksum};
+    }});
+
+    cases.push_back({"suite_equity_mc_preflop", [&pool] {
+        MonteCarloOptions options;
+        options.maxTrials = 8'000'000;
+        options.seed = 0x5e7e0101u;
+        options.pool = &pool;
+        const EquityResult r = monteCarloEquity(range("AsAh"), {range("KdKc")}, CardSet(), options);
+        return Work{r.trials, equityChecksum(r)};
+    }});
+
+    cases.push_back({"suite_equity_mc_flop_range", [&pool] {
+        MonteCarloOptions options;
+        options.maxTrials = 8'000'000;
+        options.seed = 0x5e7e0102u;
+        options.pool = &pool;
+        const EquityResult r =
+            monteCarloEquity(range("AhKh"), {range("QQ-JJ,AQs")}, cards("Kc7h2h"), options);
+        return Work{r.trials, equityChecksum(r)};
+    }});
+
+    cases.push_back({"suite_equity_exact_preflop", [&pool] {
+        ExactOptions options;
+        options.pool = &pool;
+        const EquityResult r = exactEquity(range("AsAh"), {range("KdKc")}, CardSet(), options);
+        return Work{r.trials, equityChecksum(r)};
+    }});
+
+    cases.push_back({"suite_table_6max", [] { return playTable<Holdem>(200'000, 0x5e7e0201u); }});
+
+    cases.push_back({"suite_eval_omaha", [] {
+        static const std::vector<CardSet> deals = randomOmahaDeals(1 << 18, 0x5e7e0401u);
+        uint64_t checksum = 0;
+        for (int pass = 0; pass < 4; ++pass) {
+            for (size_t i = 0; i < deals.size(); i += 2) checksum += evaluateOmaha(deals[i], deals[i + 1]);
+        }
+        return Work{deals.size() / 2 * 4, checksum};
+    }});
+
+    cases.push_back({"suite_equity_mc_omaha", [&pool] {
+        MonteCarloOptions options;
+        options.maxTrials = 1'000'000;
+        options.seed = 0x5e7e0402u;
+        options.pool = &pool;
+        const EquityResult r = handEquity<Omaha>({cards("AsAhKsKh"), CardSet()}, CardSet(), options);
+        return Work{r.trials, equityChecksum(r)};
+    }});
+
+    cases.push_back({"suite_table_6max_omaha", [] { return playTable<Omaha>(200'000, 0x5e7e0403u); }});
+
+    cases.push_back({"suite_selfplay_6max", [&pool] {
+        SimulationConfig config;
+        config.tables = 32;
+        config.handsPerTable = 10'000;
+        config.threads = static_cast<unsigned>(pool.size());
+        config.seed = 0x5e7e0301u;
+        const SimulationReport report = runSimulation(config, mixedBots);
+        uint64_t checksum = report.actions;
+        for (int s = 0; s < config.table.seats; ++s) {
+            checksum = checksum * 31 + static_cast<uint64_t>(report.net[s]);
+        }
+        return Work{report.hands, checksum};
+    }});
+
+    cases.push_back({"suite_cfr_river", [&pool] {
+        static const AbstractGame game = [] {
+            BettingConfig config;
+            config.pot = 100;
+            config.stack = 400;
+            return makeRiverGame(range("TT+,AJs+,KQs,AQo+,JTs,T9s,98s,76s,65s,A5s-A2s,KJo,QJo:0.5"),
+                                 range("99-22,ATs+,KTs+,QTs+,J9s+,T9s,98s,AJo+,KJo+,QJo,A5s:0.5"),
+                                 cards("Qs8h5d3c2h"), config);
+        }();
+        const int iterations = 1000;
+        SolverOptions options;
+        options.pool = &pool;
+        CfrSolver solver(game, options);
+        solver.iterate(iterations);
+        return Work{static_cast<uint64_t>(iterations),
+                    static_cast<uint64_t>(solver.exploitability() * 1e6 + 0.5)};
+    }});
+
+    return cases;
+}
+
+using Fields = std::map<std::string, std::string>;
+
+/// Reads the `bench=` lines of an earlier run, keyed by case name.
+std::map<std::string, Fields> readBaseline(const std::string& path) {
+    std::map<std::string, Fields> result;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.compare(0, 6, "bench=") != 0) continue;
+        Fields fields;
+        std::istringstream words(line);
+        std::string word;
+        while (words >> word) {
+            const size_t eq = word.find('=');
+            if (eq != std::string::npos) fields[word.substr(0, eq)] = word.substr(eq + 1);
+        }
+        result[fields["bench"]] = fields;
+    }
+    return result;
+}
+
+/// Prints a `compare=` line for one case; returns false on a regression.
+bool compare(FILE* out, const bench::Result& r, const Fields& base, double tolerance) {
+    const double rate = r.seconds > 0 ? r.items / r.seconds : 0.0;
+    const double baseRate = std::atof(base.at("rate_per_sec").c_str());
+    const uint64_t baseChecksum = std::strtoull(base.at("checksum").c_str(), nullptr, 10);
+    const double ratio = baseRate > 0 ? rate / baseRate : 0.0;
+    const bool slower = ratio < 1.0 - tolerance;
+    const bool changed = baseChecksum != r.checksum;
+    for (FILE* f : {out, stdout}) {
+        std::fprintf(f, "compare=%s ratio=%.3f checksum_match=%d status=%s\n", r.name, ratio, !changed,
+                     changed ? "changed" : slower ? "regressed" : "ok");
+    }
+    return !slower && !changed;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseArgs(argc, argv, options)) return 2;
+    FILE* out = std::fopen(options.output.c_str(), "w");
+    if (!out) {
+        std::perror(options.output.c_str());
+        return 1;
+    }
+    const std::map<std::string, Fields> baseline =
+        options.baseline.empty() ? std::map<std::string, Fields>() : readBaseline(options.baseline);
+    if (!options.baseline.empty() && baseline.empty()) {
+        std::fprintf(stderr, "bench_suite: no results in baseline %s\n", options.baseline.c_str());
+        return 1;
+    }
+
+    initEvaluator();
+    ThreadPool pool(options.threads);
+    for (FILE* f : {out, stdout}) {
+        std::fprintf(f, "suite=bench_suite threads=%u repeat=%d avx2=%d profiling=%d\n", options.threads,
+                     options.repeat, batchEvaluatorUsesAvx2(), profile::enabled());
+    }
+
+    bool ok = true;
+    for (const Case& c : makeCases(pool)) {
+        if (!options.filter.empty() && std::strstr(c.name, options.filter.c_str()) == nullptr) continue;
+        profile::reset();
+        bench::Result best{c.name, 0, 0, 0};
+        bool stable = true;
+        for (int run = 0; run < options.repeat; ++run) {
+            const auto start = std::chrono::steady_clock::now();
+            const Work work = c.run();
+            const double seconds = bench::secondsSince(start);
+            if (run > 0 && work.checksum != best.checksum) stable = false;
+            if (run == 0 || seconds < best.seconds) best = {c.name, work.items, seconds, work.checksum};
+        }
+        bench::printResult(out, best);
+        bench::printResult(stdout, best);
+        if (!stable) {
+            std::fprintf(stderr, "bench_suite: %s is not deterministic across runs\n", c.name);
+            ok = false;
+        }
+        const auto base = baseline.find(c.name);
+        if (base != baseline.end()) {
+            ok = compare(out, best, base->second, options.tolerance) && ok;
+        } else if (!baseline.empty()) {
+            std::fprintf(stderr, "bench_suite: %s missing from baseline\n", c.name);
+        }
+        // Totals cover every repeat of the case.
+        profile::report(out);
+        profile::report(stdout);
+    }
+    std::fclose(out);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+// Shared helpers for the benchmark executables. Every benchmark writes one
+// `key=value` record per line so results can be diffed and parsed by scripts.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+namespace bench {
+
+struct Result {
+    const char* name;
+    uint64_t items;
+    double seconds;
+    uint64_t checksum;
+};
+
+inline double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+inline void printResult(FILE* out, const Result& r) {
+    std::fprintf(out, "bench=%s items=%llu seconds=%.6f rate_per_sec=%.0f checksum=%llu\n",
+                 r.name, static_cast<unsigned long long>(r.items), r.seconds,
+                 r.seconds > 0 ? r.items / r.seconds : 0.0,
+                 static_cast<unsigned long long>(r.checksum));
+}
+
+/// Opens the output file named by argv[1], defaulting to bench_output.txt.
+inline FILE* openOutput(int argc, char** argv) {
+    const char* path = argc > 1 ? argv[1] : "bench_output.txt";
+    FILE* out = std::fopen(path, "w");
+    if (!out) std::perror(path);
+    return out;
+}
+
+} // namespace bench
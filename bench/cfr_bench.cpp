@@ -0,0 +1,63 @@
+// CFR+ solver benchmark.
+//
+// Usage: cfr_bench [output-path]   (default: bench_output.txt)
+//
+// Solves a fixed heads-up river spot with two bet sizes and raises at thread
+// counts from 1 to the hardware concurrency, reporting iterations per second
+// and exploitability as a fraction of the pot. Exploitability must be equal
+// at every thread count, since slices never share writes.
+
+#include "bench_util.hpp"
+#include "poker/cfr.hpp"
+#include "poker/thread_pool.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+using namespace poker;
+
+int main(int argc, char** argv) {
+    FILE* out = bench::openOutput(argc, argv);
+    if (!out) return 1;
+
+    Range oop, ip;
+    parseRange("TT+,AJs+,KQs,AQo+,JTs,T9s,98s,76s,65s,A5s-A2s,KJo,QJo:0.5", oop);
+    parseRange("99-22,ATs+,KTs+,QTs+,J9s+,T9s,98s,AJo+,KJo+,QJo,A5s:0.5", ip);
+    CardSet board;
+    parseCardSet("Qs8h5d3c2h", board);
+    BettingConfig config;
+    config.pot = 100;
+    config.stack = 400;
+    const AbstractGame game = makeRiverGame(oop, ip, board, config);
+    const int iterations = 500;
+
+    unsigned hardware = std::thread::hardware_concurrency();
+    if (hardware == 0) hardware = 1;
+    double reference = -1;
+    bool consistent = true;
+    for (unsigned threads = 1; threads <= hardware; threads *= 2) {
+        ThreadPool pool(threads);
+        SolverOptions options;
+        options.pool = &pool;
+        CfrSolver solver(game, options);
+        const auto start = std::chrono::steady_clock::now();
+        solver.iterate(iterations);
+        const double seconds = bench::secondsSince(start);
+        const double exploitability = solver.exploitability() / config.pot;
+        if (reference < 0) reference = exploitability;
+        consistent = consistent && exploitability == reference;
+        for (FILE* f : {out, stdout}) {
+            std::fprintf(f,
+                         "bench=cfr_river_%ut items=%d seconds=%.6f rate_per_sec=%.1f nodes=%d "
+                         "hands=%dx%d memory_bytes=%zu exploitability_pot=%.6f\n",
+                         threads, iterations, seconds, iterations / seconds, game.tree.size(),
+                         game.hands[0], game.hands[1], solver.memoryBytes(), exploitability);
+        }
+        if (threads < hardware && threads * 2 > hardware) threads = hardware / 2;
+    }
+    for (FILE* f : {out, stdout}) std::fprintf(f, "bench=cfr_consistency threads_agree=%d\n", consistent);
+    std::fclose(out);
+    return consistent ? 0 : 1;
+}
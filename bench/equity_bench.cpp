@@ -0,0 +1,202 @@
+// Monte Carlo equity benchmark.
+//
+// Usage: equity_bench [output-path]   (default: bench_output.txt)
+//
+// Runs fixed-seed Monte Carlo queries at thread counts from 1 to the hardware
+// concurrency to show trial throughput scaling, one query with the
+// confidence-interval stopping rule to show time-to-answer, and then the exact
+// enumeration path against Monte Carlo on spots small enough to enumerate.
+// Finishes with range parsing and dead-card filtering throughput, and the
+// cost of a cache hit on a suit-isomorphic query.
+
+#include "bench_util.hpp"
+#include "poker/equity.hpp"
+#include "poker/equity_cache.hpp"
+#include "poker/range.hpp"
+#include "poker/rng.hpp"
+#include "poker/thread_pool.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+using namespace poker;
+
+namespace {
+
+struct Spot {
+    const char* name;
+    const char* hero;
+    std::vector<const char*> villains;
+    const char* board;
+};
+
+Range hands(const char* text) {
+    Range range;
+    parseRange(text, range);
+    return range;
+}
+
+template <class Options>
+EquityResult runSpot(const Spot& spot, const Options& options) {
+    std::vector<Range> villains;
+    for (const char* v : spot.villains) villains.push_back(hands(v));
+    CardSet board;
+    parseCardSet(spot.board, board);
+    if constexpr (std::is_same_v<Options, ExactOptions>) {
+        return exactEquity(hands(spot.hero), villains, board, options);
+    } else {
+        return monteCarloEquity(hands(spot.hero), villains, board, options);
+    }
+}
+
+void printEquity(FILE* out, const std::string& name, unsigned threads, const EquityResult& r,
+                 double seconds) {
+    std::fprintf(out,
+                 "bench=%s threads=%u items=%llu seconds=%.6f rate_per_sec=%.0f "
+                 "equity=%.6f win=%.6f tie=%.6f stderr=%.6f\n",
+                 name.c_str(), threads, static_cast<unsigned long long>(r.trials), seconds,
+                 seconds > 0 ? r.trials / seconds : 0.0, r.equity, r.win, r.tie, r.stdError);
+}
+
+// Range parsing and card removal, which equity and solver queries repeat for
+// every board.
+void benchRanges(FILE* out) {
+    const char* text = "22+,A2s+,K9s+,Q9s+,J9s+,T9s,98s,87s,ATo+,KTo+,QTo+,JTo,AA:0.5";
+    const uint64_t parses = 20'000;
+    Range range;
+    uint64_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < parses; ++i) {
+        parseRange(text, range);
+        checksum += static_cast<uint64_t>(range.size());
+    }
+    bench::Result parse{"range_parse", parses, bench::secondsSince(start), checksum};
+
+    const uint64_t filters = 2'000'000;
+    alignas(64) float live[kNumCombos];
+    Rng rng(0x4a4e6e);
+    checksum = 0;
+    start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < filters; ++i) {
+        const CardSet dead(rng() & rng() & rng() & kFullDeckBits);
+        range.removeBlocked(dead, live);
+        checksum += static_cast<uint64_t>(live[i % kNumCombos] * 2);
+    }
+    bench::Result filter{"range_filter", filters, bench::secondsSince(start), checksum};
+    for (FILE* f : {out, stdout}) {
+        bench::printResult(f, parse);
+        bench::printResult(f, filter);
+    }
+}
+
+// An in-memory cache answering suit-relabeled copies of one spot: the first
+// query computes, the rest pay only for canonicalization and a lookup.
+void benchCache(FILE* out) {
+    EquityCache cache(1 << 16);
+    Range hero, villain;
+    parseRange("AhKh", hero);
+    parseRange("QQ-JJ,AQs", villain);
+    CardSet board;
+    parseCardSet("Kc7h2h", board);
+    MonteCarloOptions options;
+    options.maxTrials = 500'000;
+
+    auto start = std::chrono::steady_clock::now();
+    const EquityResult cold = cachedMonteCarloEquity(cache, hero, {villain}, board, options);
+    bench::Result miss{"equity_cache_miss", 1, bench::secondsSince(start),
+                       static_cast<uint64_t>(cold.equity * 1e6)};
+
+    const uint64_t queries = 20'000;
+    uint64_t checksum = 0;
+    start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < queries; ++i) {
+        const SuitPermutation& p = suitPermutation(static_cast<int>(i % kNumSuitPermutations));
+        const EquityResult r =
+            cachedMonteCarloEquity(cache, p.apply(hero), {p.apply(villain)}, p.apply(board), options);
+        checksum += r.trials == cold.trials;
+    }
+    bench::Result hit{"equity_cache_hit", queries, bench::secondsSince(start), checksum};
+    for (FILE* f : {out, stdout}) {
+        bench::printResult(f, miss);
+        bench::printResult(f, hit);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    FILE* out = bench::openOutput(argc, argv);
+    if (!out) return 1;
+
+    const std::vector<Spot> spots = {
+        {"equity_preflop_hu", "AsAh", {"KdKc"}, ""},
+        {"equity_preflop_3way", "AsKs", {"QhQd", "Jc9c"}, ""},
+        {"equity_flop_range", "AhKh", {"QQ-JJ,AQs"}, "Kc7h2h"},
+    };
+
+    unsigned hardware = std::thread::hardware_concurrency();
+    if (hardware == 0) hardware = 1;
+    for (unsigned threads = 1; threads <= hardware; threads *= 2) {
+        ThreadPool pool(threads);
+        for (const Spot& spot : spots) {
+            MonteCarloOptions options;
+            options.maxTrials = 2'000'000;
+            options.pool = &pool;
+            const auto start = std::chrono::steady_clock::now();
+            const EquityResult r = runSpot(spot, options);
+            const double seconds = bench::secondsSince(start);
+            printEquity(out, spot.name, threads, r, seconds);
+            printEquity(stdout, spot.name, threads, r, seconds);
+        }
+        if (threads < hardware && threads * 2 > hardware) threads = hardware / 2;
+    }
+
+    MonteCarloOptions early;
+    early.maxTrials = 100'000'000;
+    early.targetHalfWidth = 0.001;
+    const auto start = std::chrono::steady_clock::now();
+    const EquityResult r = runSpot(spots[0], early);
+    const double seconds = bench::secondsSince(start);
+    printEquity(out, "equity_early_exit_0.001", ThreadPool::shared().size(), r, seconds);
+    printEquity(stdout, "equity_early_exit_0.001", ThreadPool::shared().size(), r, seconds);
+
+    // Exact enumeration versus Monte Carlo at a matching trial budget. The
+    // z-score of the difference should look like a standard normal draw.
+    const std::vector<Spot> smallSpots = {
+        {"equity_flop_hu", "AhKh", {"QsQc"}, "Kc7h2h"},
+        {"equity_turn_range", "AhKh", {"QQ-JJ,AQs"}, "Kc7h2h9s"},
+        {"equity_preflop_hu", "AsAh", {"KdKc"}, ""},
+    };
+    for (const Spot& spot : smallSpots) {
+        const auto exactStart = std::chrono::steady_clock::now();
+        const EquityResult exact = runSpot(spot, ExactOptions{});
+        const double exactSeconds = bench::secondsSince(exactStart);
+        printEquity(out, std::string(spot.name) + "_exact", ThreadPool::shared().size(), exact,
+                    exactSeconds);
+        printEquity(stdout, std::string(spot.name) + "_exact", ThreadPool::shared().size(), exact,
+                    exactSeconds);
+
+        MonteCarloOptions options;
+        options.maxTrials = exact.trials;
+        const auto mcStart = std::chrono::steady_clock::now();
+        const EquityResult mc = runSpot(spot, options);
+        const double mcSeconds = bench::secondsSince(mcStart);
+        printEquity(out, std::string(spot.name) + "_mc", ThreadPool::shared().size(), mc, mcSeconds);
+        printEquity(stdout, std::string(spot.name) + "_mc", ThreadPool::shared().size(), mc,
+                    mcSeconds);
+        const double z = mc.stdError > 0 ? (mc.equity - exact.equity) / mc.stdError : 0.0;
+        std::fprintf(out, "bench=%s_compare speedup=%.3f z=%.3f\n", spot.name,
+                     exactSeconds > 0 ? mcSeconds / exactSeconds : 0.0, z);
+        std::printf("bench=%s_compare speedup=%.3f z=%.3f\n", spot.name,
+                    exactSeconds > 0 ? mcSeconds / exactSeconds : 0.0, z);
+    }
+
+    benchRanges(out);
+    benchCache(out);
+    std::fclose(out);
+    return 0;
+}
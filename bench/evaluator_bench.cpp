@@ -0,0 +1,218 @@
+// Evaluator microbenchmark.
+//
+// Usage: evaluator_bench [output-path]   (default: bench_output.txt)
+//
+// Times random 5- and 7-card evaluations from a fixed seed, both from card
+// arrays, from CardSet masks and through the batch kernel, and walks every
+// 7-card hand of the full and the short deck once, checking the category
+// histograms against the known totals. Random Omaha hands are checked against
+// the best of their 60 five-card hands. Exits with status 1 on any mismatch.
+
+#include "bench_util.hpp"
+#include "poker/evaluator.hpp"
+#include "poker/variant.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace poker;
+using bench::Result;
+using bench::secondsSince;
+
+namespace {
+
+template <int N>
+std::vector<Card> randomHands(size_t count, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<Card> cards(count * N);
+    uint8_t deck[kNumCards];
+    for (int i = 0; i < kNumCards; ++i) deck[i] = static_cast<uint8_t>(i);
+    for (size_t h = 0; h < count; ++h) {
+        for (int i = 0; i < N; ++i) {
+            const int j = i + static_cast<int>(rng() % (kNumCards - i));
+            std::swap(deck[i], deck[j]);
+            cards[h * N + i] = Card(deck[i]);
+        }
+    }
+    return cards;
+}
+
+template <int N>
+Result benchRandom(const char* name, int passes) {
+    constexpr size_t kHands = 1 << 20;
+    const std::vector<Card> cards = randomHands<N>(kHands, 0x5eed0000u + N);
+    uint64_t checksum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int p = 0; p < passes; ++p) {
+        for (size_t h = 0; h < kHands; ++h) checksum += evaluate(&cards[h * N], N);
+    }
+    return {name, kHands * passes, secondsSince(start), checksum};
+}
+
+template <int N>
+Result benchRandomSet(const char* name, int passes) {
+    constexpr size_t kHands = 1 << 20;
+    const std::vector<Card> cards = randomHands<N>(kHands, 0x5eed0000u + N);
+    std::vector<CardSet> sets(kHands);
+    for (size_t h = 0; h < kHands; ++h) {
+        for (int i = 0; i < N; ++i) sets[h].add(cards[h * N + i]);
+    }
+    uint64_t checksum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int p = 0; p < passes; ++p) {
+        for (size_t h = 0; h < kHands; ++h) checksum += evaluate(sets[h]);
+    }
+    return {name, kHands * passes, secondsSince(start), checksum};
+}
+
+template <int N>
+Result benchRandomBatch(const char* name, int passes) {
+    constexpr size_t kHands = 1 << 20;
+    const std::vector<Card> cards = randomHands<N>(kHands, 0x5eed0000u + N);
+    std::vector<CardSet> sets(kHands);
+    for (size_t h = 0; h < kHands; ++h) {
+        for (int i = 0; i < N; ++i) sets[h].add(cards[h * N + i]);
+    }
+    std::vector<HandValue> values(kHands);
+    uint64_t checksum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int p = 0; p < passes; ++p) {
+        evaluateBatch(sets.data(), values.data(), kHands);
+        for (HandValue v : values) checksum += v;
+    }
+    return {name, kHands * passes, secondsSince(start), checksum};
+}
+
+// Walks every 7-card hand of the variant's deck and compares the category
+// histogram with `expected`, indexed by HandCategory.
+template <class Variant>
+Result benchExhaustive7(const char* name, const uint64_t (&expected)[kNumHandCategories], bool& ok) {
+    using Ranking = typename Variant::Ranking;
+    constexpr int n = kDeckSize<Variant>;
+    const auto& deck = kDeckCards<Variant>;
+    uint64_t histogram[kNumHandCategories] = {};
+    uint64_t checksum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int a = 0; a < n; ++a) {
+        const CardSet h1(deck[a]);
+        for (int b = a + 1; b < n; ++b) {
+            const CardSet h2 = h1 | CardSet(deck[b]);
+            for (int c = b + 1; c < n; ++c) {
+                const CardSet h3 = h2 | CardSet(deck[c]);
+                for (int d = c + 1; d < n; ++d) {
+                    const CardSet h4 = h3 | CardSet(deck[d]);
+                    for (int e = d + 1; e < n; ++e) {
+                        const CardSet h5 = h4 | CardSet(deck[e]);
+                        for (int f = e + 1; f < n; ++f) {
+                            const CardSet h6 = h5 | CardSet(deck[f]);
+                            for (int g = f + 1; g < n; ++g) {
+                                const HandValue v = evaluate<Ranking>(h6 | CardSet(deck[g]));
+                                ++histogram[static_cast<int>(handCategory<Ranking>(v))];
+                                checksum += v;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    const double seconds = secondsSince(start);
+    uint64_t total = 0;
+    for (int i = 0; i < kNumHandCategories; ++i) {
+        total += histogram[i];
+        if (histogram[i] != expected[i]) {
+            std::fprintf(stderr, "%s %s: got %llu, expected %llu\n", name,
+                         categoryName(static_cast<HandCategory>(i)),
+                         static_cast<unsigned long long>(histogram[i]),
+                         static_cast<unsigned long long>(expected[i]));
+            ok = false;
+        }
+    }
+    return {name, total, seconds, checksum};
+}
+
+// Times evaluateOmaha() on random hands with 3- to 5-card boards and checks
+// each against the best of the five-card hands of two hole and three board
+// cards, evaluated one by one.
+Result benchOmaha(bool& ok) {
+    constexpr size_t kHands = 1 << 18;
+    const std::vector<Card> cards = randomHands<9>(kHands, 0x0a4a4a00u);
+    std::vector<CardSet> holes(kHands), boards(kHands);
+    for (size_t h = 0; h < kHands; ++h) {
+        const int boardSize = 3 + static_cast<int>(h % 3);
+        for (int i = 0; i < 4; ++i) holes[h].add(cards[h * 9 + i]);
+        for (int i = 0; i < boardSize; ++i) boards[h].add(cards[h * 9 + 4 + i]);
+    }
+    uint64_t checksum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t h = 0; h < kHands; ++h) checksum += evaluateOmaha(holes[h], boards[h]);
+    const double seconds = secondsSince(start);
+
+    uint64_t mismatches = 0;
+    for (size_t h = 0; h < kHands; ++h) {
+        const Card* hole = &cards[h * 9];
+        const Card* board = hole + 4;
+        const int boardSize = 3 + static_cast<int>(h % 3);
+        HandValue best = 0;
+        for (int a = 0; a < 4; ++a) {
+            for (int b = a + 1; b < 4; ++b) {
+                for (int x = 0; x < boardSize; ++x) {
+                    for (int y = x + 1; y < boardSize; ++y) {
+                        for (int z = y + 1; z < boardSize; ++z) {
+                            const Card five[5] = {hole[a], hole[b], board[x], board[y], board[z]};
+                            best = std::max(best, evaluate(five, 5));
+                        }
+                    }
+                }
+            }
+        }
+        mismatches += evaluateOmaha(holes[h], boards[h]) != best;
+    }
+    if (mismatches != 0) {
+        std::fprintf(stderr, "omaha: %llu hands differ from the best of their five-card hands\n",
+                     static_cast<unsigned long long>(mismatches));
+        ok = false;
+    }
+    return {"omaha_random", kHands, seconds, checksum};
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    FILE* out = bench::openOutput(argc, argv);
+    if (!out) return 1;
+
+    const auto initStart = std::chrono::steady_clock::now();
+    initEvaluator();
+    std::fprintf(out, "bench=eval_init seconds=%.6f\n", secondsSince(initStart));
+    initEvaluator<ShortDeckRanking>();
+
+    static constexpr uint64_t kStandard7[kNumHandCategories] = {
+        23294460, 58627800, 31433400, 6461620, 6180020, 4047644, 3473184, 224848, 41584,
+    };
+    static constexpr uint64_t kShortDeck7[kNumHandCategories] = {
+        233100, 2316600, 3157056, 607200, 1169940, 175560, 633024, 44640, 10560,
+    };
+    bool ok = true;
+    const Result results[] = {
+        benchRandom<5>("eval5_random", 20),
+        benchRandom<7>("eval7_random", 20),
+        benchRandomSet<5>("eval5_random_set", 20),
+        benchRandomSet<7>("eval7_random_set", 20),
+        benchRandomBatch<7>(batchEvaluatorUsesAvx2() ? "eval7_batch_avx2" : "eval7_batch_scalar",
+                            20),
+        benchExhaustive7<Holdem>("eval7_exhaustive", kStandard7, ok),
+        benchExhaustive7<ShortDeck>("eval7_exhaustive_shortdeck", kShortDeck7, ok),
+        benchOmaha(ok),
+    };
+    for (const Result& r : results) {
+        bench::printResult(out, r);
+        bench::printResult(stdout, r);
+    }
+    std::fclose(out);
+    return ok ? 0 : 1;
+}
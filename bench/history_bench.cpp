@@ -0,0 +1,84 @@
+// Hand-history benchmark.
+//
+// Usage: history_bench [output-path]   (default: bench_output.txt)
+//
+// Logs fixed-seed 6-max self-play hands to a binary history file, then maps
+// the file and aggregates every event of every hand, and finally converts
+// the file to text and back, checking the round trip is byte-identical. The
+// scratch files are removed afterwards.
+
+#include "bench_util.hpp"
+#include "poker/hand_history.hpp"
+#include "poker/simulator.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+using namespace poker;
+
+namespace {
+
+const char* const kScratch = "history_bench.phh";
+
+std::string slurp(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    FILE* out = bench::openOutput(argc, argv);
+    if (!out) return 1;
+    initEvaluator();
+
+    // Logging: the same self-play run with and without a history writer.
+    SimulationConfig config;
+    config.tables = 16;
+    config.handsPerTable = 50'000;
+    config.threads = 1;
+    const SimulationReport plain = runSimulation(config, [](int) { return makeCallingStationBot(); });
+    const std::string path = std::string(kScratch) + ".0";
+    std::remove(path.c_str());
+    config.historyPath = kScratch;
+    const SimulationReport logged = runSimulation(config, [](int) { return makeCallingStationBot(); });
+    const double perHand = (logged.seconds - plain.seconds) / logged.hands;
+
+    // Replay: walk every event of every hand in place.
+    HandHistoryReader reader(path);
+    uint64_t hands = 0;
+    uint64_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const HandView& hand : reader) {
+        EventReader events = hand.events();
+        HandEvent e;
+        while (events.next(e)) checksum += static_cast<uint64_t>(e.amount);
+        ++hands;
+    }
+    bench::Result replay{"history_replay", hands, bench::secondsSince(start), checksum};
+
+    // Text round trip on the first file.
+    start = std::chrono::steady_clock::now();
+    const bool toTextOk = historyToText(path, path + ".txt");
+    const bool backOk = textToHistory(path + ".txt", path + ".back");
+    const double convertSeconds = bench::secondsSince(start);
+    const bool identical = toTextOk && backOk && slurp(path) == slurp(path + ".back");
+
+    for (FILE* f : {out, stdout}) {
+        std::fprintf(f,
+                     "bench=history_write items=%llu bytes=%zu bytes_per_hand=%.1f "
+                     "overhead_ns_per_hand=%.1f write_errors=%llu\n",
+                     static_cast<unsigned long long>(logged.hands), reader.size(),
+                     static_cast<double>(reader.size()) / logged.hands, perHand * 1e9,
+                     static_cast<unsigned long long>(logged.historyErrors));
+        bench::printResult(f, replay);
+        std::fprintf(f, "bench=history_text_roundtrip items=%llu seconds=%.6f identical=%d\n",
+                     static_cast<unsigned long long>(hands), convertSeconds, identical ? 1 : 0);
+    }
+    for (const char* suffix : {"", ".txt", ".back"}) std::remove((path + suffix).c_str());
+    std::fclose(out);
+    return identical && !reader.corrupt() && logged.historyErrors == 0 ? 0 : 1;
+}
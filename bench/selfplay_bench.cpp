@@ -0,0 +1,66 @@
+// Self-play simulator benchmark.
+//
+// Usage: selfplay_bench [output-path]   (default: bench_output.txt)
+//
+// Runs 6-max tables of mixed bots sharded over 1, 2, 4, ... threads up to the
+// hardware concurrency, and reports total and per-core hands per second plus
+// each strategy's net result in big blinds per 100 hands. The chip totals
+// must match across thread counts, which the `net_*` fields make visible.
+
+#include "bench_util.hpp"
+#include "poker/simulator.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+
+using namespace poker;
+
+namespace {
+
+std::unique_ptr<Bot> mixedBots(int seat) {
+    switch (seat % 3) {
+    case 0: return makeTightAggressiveBot();
+    case 1: return makeCallingStationBot();
+    default: return makeRandomBot();
+    }
+}
+
+void benchSelfPlay(FILE* out, unsigned threads) {
+    SimulationConfig config;
+    config.tables = 64;
+    config.handsPerTable = 4000;
+    config.threads = threads;
+    config.pinThreads = true;
+    const SimulationReport report = runSimulation(config, mixedBots);
+
+    const Chips bigBlind = config.table.bigBlind;
+    double bb100[3] = {};
+    for (int s = 0; s < config.table.seats; ++s) {
+        bb100[s % 3] += 100.0 * report.net[s] / bigBlind / report.hands;
+    }
+    for (FILE* f : {out, stdout}) {
+        std::fprintf(f,
+                     "bench=selfplay_%ut items=%llu seconds=%.6f rate_per_sec=%.0f "
+                     "rate_per_core=%.0f actions=%llu illegal=%llu net_tag=%.2f "
+                     "net_station=%.2f net_random=%.2f\n",
+                     threads, static_cast<unsigned long long>(report.hands), report.seconds,
+                     report.handsPerSecond(), report.handsPerSecondPerCore(),
+                     static_cast<unsigned long long>(report.actions),
+                     static_cast<unsigned long long>(report.illegalActions), bb100[0], bb100[1],
+                     bb100[2]);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    FILE* out = bench::openOutput(argc, argv);
+    if (!out) return 1;
+    initEvaluator();
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned threads = 1; threads < cores; threads *= 2) benchSelfPlay(out, threads);
+    benchSelfPlay(out, cores);
+    std::fclose(out);
+    return 0;
+}
@@ -0,0 +1,65 @@
+// Game server benchmark.
+//
+// Usage: server_bench [output-path]   (default: bench_output.txt)
+//
+// Starts a GameServer on a loopback port and drives it with the load client
+// at increasing connection counts, reporting action latency percentiles,
+// actions per second, and how well the server batches its writes.
+// Everything runs in this process over 127.0.0.1.
+
+#include "bench_util.hpp"
+#include "poker/load_client.hpp"
+#include "poker/server.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+
+using namespace poker;
+
+int main(int argc, char** argv) {
+    FILE* out = bench::openOutput(argc, argv);
+    if (!out) return 1;
+
+    // Each connection needs a descriptor on both ends.
+    const size_t limit = raiseOpenFileLimit(16384);
+    unsigned hardware = std::thread::hardware_concurrency();
+    if (hardware == 0) hardware = 1;
+
+    for (int connections : {60, 600, 3000}) {
+        if (static_cast<size_t>(connections) * 2 + 64 > limit) {
+            std::fprintf(stderr, "skipping %d connections: open-file limit is %zu\n", connections, limit);
+            continue;
+        }
+        ServerConfig serverConfig;
+        serverConfig.threads = std::max(1u, hardware / 2);
+        serverConfig.table.seats = 6;
+        GameServer server(serverConfig);
+        server.start();
+
+        LoadClientConfig clientConfig;
+        clientConfig.port = server.port();
+        clientConfig.connections = connections;
+        clientConfig.threads = std::max(1u, hardware - serverConfig.threads);
+        clientConfig.seconds = 2;
+        const LoadReport report = runLoadClient(clientConfig);
+        server.stop();
+        const ServerStats stats = server.stats();
+
+        for (FILE* f : {out, stdout}) {
+            std::fprintf(f,
+                         "bench=server_%dconn items=%llu seconds=%.6f rate_per_sec=%.0f "
+                         "p50_us=%.1f p99_us=%.1f p999_us=%.1f max_us=%.1f "
+                         "tables=%llu messages_per_write=%.2f buffers=%llu errors=%llu\n",
+                         connections, static_cast<unsigned long long>(report.actions), report.seconds,
+                         report.actionsPerSecond(), report.p50Micros,
+                         report.p99Micros, report.p999Micros, report.maxMicros,
+                         static_cast<unsigned long long>(stats.tables),
+                         stats.writeCalls ? double(stats.messagesOut) / stats.writeCalls : 0.0,
+                         static_cast<unsigned long long>(stats.buffers),
+                         static_cast<unsigned long long>(report.errors));
+        }
+    }
+    std::fclose(out);
+    return 0;
+}
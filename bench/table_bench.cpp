@@ -0,0 +1,93 @@
+// Game-engine benchmark.
+//
+// Usage: table_bench [output-path]   (default: bench_output.txt)
+//
+// Plays fixed-seed hands at tables of several sizes with players that pick
+// random legal actions, and counts heap allocations made while hands are in
+// play, which should be zero once the tables are built.
+
+#include "bench_util.hpp"
+#include "poker/rng.hpp"
+#include "poker/table.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<uint64_t> gAllocations{0};
+
+} // namespace
+
+void* operator new(size_t size) {
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+using namespace poker;
+
+namespace {
+
+Action randomAction(const LegalActions& legal, Rng& rng) {
+    const uint32_t roll = rng.below(100);
+    if (roll < 15 && !legal.canCheck) return Action::fold();
+    if (roll < 80 || !legal.canRaise) return legal.canCheck ? Action::check() : Action::call();
+    const Chips span = legal.maxRaiseTo - legal.minRaiseTo;
+    const Chips extra = span > 0 ? rng.below(static_cast<uint32_t>(span) + 1) : 0;
+    return Action::raiseTo(legal.minRaiseTo + extra);
+}
+
+void benchTable(FILE* out, int seats, uint64_t hands) {
+    TableConfig config;
+    config.seats = seats;
+    Table table(config);
+    Rng rng(0x7ab1e000u + seats);
+    for (int s = 0; s < seats; ++s) table.seatPlayer(s, 200);
+
+    uint64_t actions = 0;
+    uint64_t checksum = 0;
+    const uint64_t allocationsBefore = gAllocations.load();
+    const auto start = std::chrono::steady_clock::now();
+    for (uint64_t h = 0; h < hands; ++h) {
+        for (int s = 0; s < seats; ++s) {
+            if (table.state().seats[s].stack == 0) table.seatPlayer(s, 200);
+        }
+        table.startHand(rng);
+        while (table.handInProgress()) {
+            table.act(randomAction(table.legalActions(), rng));
+            ++actions;
+        }
+        checksum += static_cast<uint64_t>(table.state().totalPot());
+    }
+    const double seconds = bench::secondsSince(start);
+    const uint64_t allocations = gAllocations.load() - allocationsBefore;
+
+    for (FILE* f : {out, stdout}) {
+        std::fprintf(f,
+                     "bench=table_%dmax items=%llu seconds=%.6f rate_per_sec=%.0f actions=%llu "
+                     "heap_allocs=%llu arena_high_water=%zu checksum=%llu\n",
+                     seats, static_cast<unsigned long long>(hands), seconds, hands / seconds,
+                     static_cast<unsigned long long>(actions),
+                     static_cast<unsigned long long>(allocations), table.arena().highWater(),
+                     static_cast<unsigned long long>(checksum));
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    FILE* out = bench::openOutput(argc, argv);
+    if (!out) return 1;
+    initEvaluator();
+    benchTable(out, 2, 1'000'000);
+    benchTable(out, 6, 500'000);
+    benchTable(out, 9, 500'000);
+    std::fclose(out);
+    return 0;
+}
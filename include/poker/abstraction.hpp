@@ -0,0 +1,124 @@
+#pragma once
+
+#include "poker/card_set.hpp"
+#include "poker/table.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace poker {
+
+class ThreadPool;
+
+/// Betting rounds that have a card abstraction (Preflop through River).
+inline constexpr int kNumStreets = 4;
+
+/// Hole cards plus board up to suit relabeling, packed in 64 bits: the
+/// canonical board in the low 52 bits, the combo index of the hole cards in
+/// the next 11 and a marker in the top bit, so a key is never zero. Two
+/// hands get the same key exactly when a suit relabeling maps one onto the
+/// other.
+uint64_t canonicalHandKey(CardSet hole, CardSet board);
+
+/// Cards of a canonical hand key.
+void decodeHandKey(uint64_t key, CardSet& hole, CardSet& board);
+
+/// Keys of every canonical hand on a street (169 preflop, 1,286,792 on the
+/// flop, 13,960,050 on the turn, 123,156,254 on the river), grouped by board
+/// in colex order.
+std::vector<uint64_t> canonicalHands(Street street, ThreadPool* pool = nullptr);
+
+struct StreetAbstractionConfig {
+    bool enabled = true;
+    int buckets = 200;          ///< at most 65535; a street with fewer hands keeps them all
+    int bins = 16;              ///< histogram bins over [0, 1] equity
+    int rollouts = 32;          ///< board completions per hand (1 on the river)
+    /// Opponent hands per completed board; 0 enumerates all of them.
+    int opponentSamples = 32;
+    /// k-means is fitted on at most this many hands (an evenly spaced
+    /// subset); every hand is then assigned to its nearest centroid.
+    size_t fitHands = 1'000'000;
+    int iterations = 25;
+};
+
+struct AbstractionConfig {
+    /// Preflop defaults to the lossless 169 buckets.
+    StreetAbstractionConfig streets[kNumStreets] = {
+        {true, 169, 16, 1024, 0, 1'000'000, 25},
+        {true, 200, 16, 32, 32, 1'000'000, 25},
+        {true, 200, 16, 16, 32, 1'000'000, 25},
+        {true, 200, 16, 1, 64, 1'000'000, 25},
+    };
+    uint64_t seed = 0x616273747261ull;
+    ThreadPool* pool = nullptr;   ///< shared pool when null
+};
+
+struct StreetAbstractionReport {
+    size_t hands = 0;
+    int buckets = 0;
+    int iterations = 0;
+    double inertia = 0;           ///< k-means objective on the fitted hands
+    double seconds = 0;
+};
+
+struct AbstractionReport {
+    StreetAbstractionReport streets[kNumStreets];
+    size_t fileBytes = 0;
+};
+
+/// Buckets every canonical hand of each enabled street and writes the map to
+/// `path` (via a temporary file and a rename).
+///
+/// A hand's feature is the cumulative histogram of its equity against a
+/// random opponent over random board completions, so the squared distance
+/// between two features tracks the earth mover's distance between their
+/// equity distributions. Features are clustered with kMeans() and buckets
+/// are numbered by ascending mean equity. Everything is seeded from
+/// `config.seed` and is the same for any thread count.
+///
+/// Throws std::invalid_argument for a bad configuration and
+/// std::runtime_error if the file cannot be written.
+AbstractionReport buildAbstraction(const AbstractionConfig& config, const std::string& path);
+
+/// Read-only view of a bucket map written by buildAbstraction().
+///
+/// The file is mapped, not read: opening costs one mmap regardless of its
+/// size and pages are faulted in as lookups touch them, so solvers and bots
+/// can share one copy through the page cache. Each street is an
+/// open-addressing table of canonical hand keys with a parallel array of
+/// 16-bit buckets; a lookup canonicalizes the cards and probes once or twice.
+class BucketMap {
+public:
+    /// Throws std::runtime_error if the file is missing or malformed.
+    explicit BucketMap(const std::string& path);
+    ~BucketMap();
+
+    BucketMap(const BucketMap&) = delete;
+    BucketMap& operator=(const BucketMap&) = delete;
+
+    /// Bucket of `hole` (two cards) on `board` (0, 3, 4 or 5 cards), or -1
+    /// if the street was not built or the cards are not a valid hand.
+    int bucket(CardSet hole, CardSet board) const;
+
+    bool hasStreet(Street street) const { return buckets(street) > 0; }
+    int buckets(Street street) const;
+    size_t hands(Street street) const;
+    size_t fileBytes() const { return bytes_; }
+
+private:
+    struct StreetTable {
+        const uint64_t* keys = nullptr;
+        const uint16_t* buckets = nullptr;
+        uint32_t slotBits = 0;
+        uint64_t hands = 0;
+        int bucketCount = 0;
+    };
+
+    void* base_ = nullptr;
+    size_t bytes_ = 0;
+    StreetTable streets_[kNumStreets];
+};
+
+} // namespace poker
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "poker/hand_history.hpp"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace poker {
+
+class ThreadPool;
+
+/// Counters for one player. Every field is a plain sum, so two PlayerStats
+/// merge by adding them field by field and the merge order never matters.
+struct PlayerStats {
+    uint64_t hands = 0;
+    uint64_t vpip = 0;          ///< hands with a voluntary preflop call, bet or raise
+    uint64_t pfr = 0;           ///< hands with a preflop bet or raise
+    uint64_t bets = 0;          ///< postflop bets and raises
+    uint64_t calls = 0;         ///< postflop calls
+    uint64_t folds = 0;
+    uint64_t showdowns = 0;
+    uint64_t showdownWins = 0;  ///< showdowns where the player won any pot
+    Chips net = 0;              ///< chips won minus chips put in
+
+    PlayerStats& operator+=(const PlayerStats& o);
+
+    double vpipRate() const { return hands ? double(vpip) / hands : 0.0; }
+    double pfrRate() const { return hands ? double(pfr) / hands : 0.0; }
+    /// Postflop (bets + raises) / calls.
+    double aggression() const { return calls ? double(bets) / calls : double(bets); }
+    double showdownWinRate() const { return showdowns ? double(showdownWins) / showdowns : 0.0; }
+};
+
+/// Player id; any 64-bit value.
+using PlayerId = uint64_t;
+
+/// Maps a seat of a recorded hand to a player id.
+using PlayerKeyFn = PlayerId (*)(const HandHeader& header, int seat);
+
+/// One player per seat of each table: tableId * kMaxSeats + seat.
+PlayerId tableSeatKey(const HandHeader& header, int seat);
+/// One player per seat number across all tables, e.g. a bot per seat in
+/// self-play.
+PlayerId seatKey(const HandHeader& header, int seat);
+
+/// Per-player totals keyed by player id. Ids need not be dense; only players
+/// seen in some hand take space.
+class HandStats {
+public:
+    /// Adds one hand; ids come from `key`. Events naming a seat that was not
+    /// dealt in are skipped.
+    void add(const HandView& hand, PlayerKeyFn key);
+    void merge(const HandStats& other);
+
+    uint64_t hands() const { return hands_; }
+    /// Stats of player `id`; all zero for an id never seen.
+    PlayerStats player(PlayerId id) const;
+    /// Every player seen, in ascending id order.
+    std::vector<std::pair<PlayerId, PlayerStats>> players() const;
+
+private:
+    friend class StatsPipeline;
+
+    PlayerStats& at(PlayerId id) { return players_[id]; }
+
+    std::unordered_map<PlayerId, PlayerStats> players_;
+    uint64_t hands_ = 0;
+};
+
+/// Incremental, parallel statistics over hand-history files.
+///
+/// `update()` maps a file, skips what earlier updates consumed, and cuts the
+/// rest into chunks of whole records by hopping over length prefixes. Chunks
+/// run on a work-stealing pool; each worker folds its chunks into its own
+/// HandStats and the worker totals are merged into the running totals at the
+/// end. Files only ever grow by appends, so the consumed offset per file is
+/// the whole incremental state. A record still being written at the end of a
+/// file is left for the next update.
+///
+/// `save()` and `load()` persist the totals and offsets, so a nightly job
+/// reads only the hands logged since the previous night.
+class StatsPipeline {
+public:
+    explicit StatsPipeline(PlayerKeyFn key = tableSeatKey, ThreadPool* pool = nullptr);
+
+    /// Processes the hands appended to `path` since the last update and
+    /// returns how many there were. Throws std::runtime_error if the file is
+    /// not a hand history, or if it shrank below the consumed offset.
+    uint64_t update(const std::string& path);
+
+    const HandStats& stats() const { return stats_; }
+    /// Bytes of `path` already consumed.
+    uint64_t offset(const std::string& path) const;
+
+    bool save(const std::string& path) const;
+    /// Replaces the state with one written by save(). Returns false on I/O
+    /// errors or a malformed file, leaving the state unchanged.
+    bool load(const std::string& path);
+
+private:
+    PlayerKeyFn key_;
+    ThreadPool* pool_;
+    HandStats stats_;
+    std::vector<std::pair<std::string, uint64_t>> offsets_;
+};
+
+} // namespace poker
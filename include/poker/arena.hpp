@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+namespace poker {
+
+/// Bump allocator over one buffer that is allocated when the arena is built.
+///
+/// Allocation is a pointer increment; nothing is freed individually. `reset()`
+/// discards everything at once, which suits per-hand data that all dies
+/// together. When the buffer is exhausted `allocate()` returns nullptr rather
+/// than falling back to the heap.
+class Arena {
+public:
+    explicit Arena(size_t capacity)
+        : buffer_(capacity ? new std::byte[capacity] : nullptr), capacity_(capacity) {}
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    Arena(Arena&&) = default;
+    Arena& operator=(Arena&&) = default;
+
+    void* allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+        const uintptr_t base = reinterpret_cast<uintptr_t>(buffer_.get());
+        const size_t start = ((base + used_ + align - 1) & ~(uintptr_t(align) - 1)) - base;
+        if (start + size > capacity_) return nullptr;
+        used_ = start + size;
+        if (used_ > highWater_) highWater_ = used_;
+        return buffer_.get() + start;
+    }
+
+    /// Storage for `count` objects of a trivially destructible type, or nullptr.
+    template <class T>
+    T* allocateArray(size_t count) {
+        static_assert(std::is_trivially_destructible_v<T>, "arena memory is never destroyed");
+        void* p = allocate(sizeof(T) * count, alignof(T));
+        return p ? static_cast<T*>(p) : nullptr;
+    }
+
+    void reset() { used_ = 0; }
+
+    /// Frees everything allocated since `used()` returned `mark`, for
+    /// stack-like use in recursive code.
+    void rewind(size_t mark) {
+        if (mark < used_) used_ = mark;
+    }
+
+    size_t used() const { return used_; }
+    size_t capacity() const { return capacity_; }
+    /// Largest `used()` seen since construction; handy for sizing arenas.
+    size_t highWater() const { return highWater_; }
+
+private:
+    std::unique_ptr<std::byte[]> buffer_;
+    size_t capacity_ = 0;
+    size_t used_ = 0;
+    size_t highWater_ = 0;
+};
+
+/// Append-only sequence stored in fixed-size blocks carved from an Arena.
+///
+/// Appends never move earlier elements. The list does not own its memory: it
+/// must be `clear()`ed whenever its arena is reset. If the arena runs out the
+/// append is dropped and `truncated()` reports it.
+template <class T, size_t BlockSize = 64>
+class ArenaList {
+    static_assert(std::is_trivially_copyable_v<T>, "ArenaList holds plain records");
+
+    struct Block {
+        Block* next;
+        size_t count;
+        T items[BlockSize];
+    };
+
+public:
+    explicit ArenaList(Arena& arena) : arena_(&arena) {}
+
+    bool push(const T& value) {
+        if (!tail_ || tail_->count == BlockSize) {
+            Block* block = arena_->allocateArray<Block>(1);
+            if (!block) {
+                truncated_ = true;
+                return false;
+            }
+            block->next = nullptr;
+            block->count = 0;
+            (tail_ ? tail_->next : head_) = block;
+            tail_ = block;
+        }
+        tail_->items[tail_->count++] = value;
+        ++size_;
+        return true;
+    }
+
+    void clear() {
+        head_ = tail_ = nullptr;
+        size_ = 0;
+        truncated_ = false;
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    bool truncated() const { return truncated_; }
+
+    class Iterator {
+    public:
+        Iterator(const Block* block, size_t index) : block_(block), index_(index) {}
+        const T& operator*() const { return block_->items[index_]; }
+        const T* operator->() const { return &block_->items[index_]; }
+        Iterator& operator++() {
+            if (++index_ == block_->count) {
+                block_ = block_->next;
+                index_ = 0;
+            }
+            return *this;
+        }
+        bool operator!=(const Iterator& o) const { return block_ != o.block_ || index_ != o.index_; }
+
+    private:
+        const Block* block_;
+        size_t index_;
+    };
+
+    Iterator begin() const { return Iterator(head_, 0); }
+    Iterator end() const { return Iterator(nullptr, 0); }
+
+private:
+    Arena* arena_;
+    Block* head_ = nullptr;
+    Block* tail_ = nullptr;
+    size_t size_ = 0;
+    bool truncated_ = false;
+};
+
+} // namespace poker
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "poker/table.hpp"
+
+#include <memory>
+
+namespace poker {
+
+class BucketMap;
+class Rng;
+
+/// A player policy. The simulator gives every thread its own instances, so
+/// implementations may keep mutable state without locking.
+class Bot {
+public:
+    virtual ~Bot() = default;
+
+    /// Chooses an action for `seat`, which is the seat to act at `table`.
+    /// Illegal choices are replaced by check, or fold when facing a bet.
+    virtual Action act(const Table& table, int seat, const LegalActions& legal, Rng& rng) = 0;
+
+    virtual const char* name() const = 0;
+};
+
+/// Picks uniformly among fold, check/call and a random legal raise.
+std::unique_ptr<Bot> makeRandomBot();
+
+/// Never folds and never raises.
+std::unique_ptr<Bot> makeCallingStationBot();
+
+/// Plays a fixed hand-strength chart preflop and bets made hands postflop.
+std::unique_ptr<Bot> makeTightAggressiveBot();
+
+/// Plays from a card abstraction: buckets are numbered by ascending equity,
+/// so a hand's bucket over the street's bucket count is its strength. Raises
+/// the strongest buckets, calls small bets with the next band and folds the
+/// rest, at the tight-aggressive bot's prices. Streets missing from the map
+/// are played like makeTightAggressiveBot(). `map` must outlive the bot;
+/// lookups are read-only, so bots on many threads may share it.
+std::unique_ptr<Bot> makeBucketBot(const BucketMap& map);
+
+} // namespace poker
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace poker {
+
+/// Fixed-size byte buffer handed out by a BufferPool. `data()[begin, end)`
+/// holds unconsumed bytes; `next` chains buffers into queues.
+struct PooledBuffer {
+    PooledBuffer* next = nullptr;
+    uint32_t begin = 0;
+    uint32_t end = 0;
+
+    uint8_t* data() { return reinterpret_cast<uint8_t*>(this + 1); }
+    size_t size() const { return end - begin; }
+};
+
+/// Free list of equal-sized buffers carved from slabs that are never
+/// returned to the heap.
+///
+/// Connections take a buffer only while they have bytes to hold and give it
+/// back as soon as it drains, so thousands of idle connections cost no
+/// buffer memory and busy ones never allocate. Not thread-safe: each event
+/// loop owns its pool.
+class BufferPool {
+public:
+    /// `bufferBytes` of payload per buffer, allocated `perSlab` at a time.
+    explicit BufferPool(size_t bufferBytes, size_t perSlab = 256)
+        : bufferBytes_(bufferBytes), stride_(roundUp(sizeof(PooledBuffer) + bufferBytes)),
+          perSlab_(perSlab ? perSlab : 1) {}
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    PooledBuffer* acquire() {
+        if (!free_) grow();
+        PooledBuffer* buffer = free_;
+        free_ = buffer->next;
+        buffer->next = nullptr;
+        buffer->begin = buffer->end = 0;
+        ++inUse_;
+        return buffer;
+    }
+
+    void release(PooledBuffer* buffer) {
+        buffer->next = free_;
+        free_ = buffer;
+        --inUse_;
+    }
+
+    size_t bufferBytes() const { return bufferBytes_; }
+    size_t inUse() const { return inUse_; }
+    /// Buffers ever allocated; the pool's footprint is this times the stride.
+    size_t allocated() const { return slabs_.size() * perSlab_; }
+
+private:
+    static size_t roundUp(size_t n) { return (n + 63) & ~size_t{63}; }
+
+    void grow() {
+        slabs_.push_back(std::make_unique<std::byte[]>(stride_ * perSlab_));
+        std::byte* slab = slabs_.back().get();
+        for (size_t i = perSlab_; i-- > 0;) {
+            PooledBuffer* buffer = new (slab + i * stride_) PooledBuffer;
+            buffer->next = free_;
+            free_ = buffer;
+        }
+    }
+
+    size_t bufferBytes_;
+    size_t stride_;
+    size_t perSlab_;
+    PooledBuffer* free_ = nullptr;
+    size_t inUse_ = 0;
+    std::vector<std::unique_ptr<std::byte[]>> slabs_;
+};
+
+} // namespace poker
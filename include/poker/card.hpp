@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace poker {
+
+/// Number of ranks (2..A) and suits (c, d, h, s) in a standard deck.
+inline constexpr int kNumRanks = 13;
+inline constexpr int kNumSuits = 4;
+inline constexpr int kNumCards = kNumRanks * kNumSuits;
+
+/// Rank indices: 0 = deuce, ..., 12 = ace.
+enum Rank : uint8_t {
+    kTwo, kThree, kFour, kFive, kSix, kSeven, kEight, kNine, kTen,
+    kJack, kQueen, kKing, kAce
+};
+
+/// Suit indices, in the order used by the card id encoding.
+enum Suit : uint8_t { kClubs, kDiamonds, kHearts, kSpades };
+
+/// A single card, encoded as `suit * 13 + rank` (0..51).
+///
+/// The id doubles as the bit position of the card in a 52-bit hand mask, so
+/// the suit-major layout keeps every suit in its own contiguous 13-bit lane.
+struct Card {
+    uint8_t id = 0;
+
+    constexpr Card() = default;
+    constexpr explicit Card(uint8_t cardId) : id(cardId) {}
+    constexpr Card(int rank, int suit) : id(static_cast<uint8_t>(suit * kNumRanks + rank)) {}
+
+    constexpr int rank() const { return id % kNumRanks; }
+    constexpr int suit() const { return id / kNumRanks; }
+
+    friend constexpr bool operator==(Card a, Card b) { return a.id == b.id; }
+    friend constexpr bool operator!=(Card a, Card b) { return a.id != b.id; }
+    friend constexpr bool operator<(Card a, Card b) { return a.id < b.id; }
+};
+
+/// Rank character for a rank index ('2'..'9', 'T', 'J', 'Q', 'K', 'A').
+char rankChar(int rank);
+/// Suit character for a suit index ('c', 'd', 'h', 's').
+char suitChar(int suit);
+/// Rank index for a rank character, or -1 if the character is not a rank.
+int parseRank(char c);
+/// Suit index for a suit character, or -1 if the character is not a suit.
+int parseSuit(char c);
+
+/// Two-character form of a card, e.g. "As" or "Td".
+std::string toString(Card card);
+
+/// Parses a two-character card such as "As". Returns false on malformed input.
+bool parseCard(std::string_view text, Card& out);
+
+/// Parses a run of cards such as "AsKd7h" (whitespace is ignored). Writes at
+/// most `capacity` cards and returns how many were parsed, or -1 on error.
+int parseCards(std::string_view text, Card* out, int capacity);
+
+} // namespace poker
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "poker/card.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace poker {
+
+/// Bits 0..51 of a card mask; bit `card.id` is set when the card is present.
+inline constexpr uint64_t kFullDeckBits = (uint64_t{1} << kNumCards) - 1;
+inline constexpr uint16_t kAllRanksMask = (1u << kNumRanks) - 1;
+
+/// All 13 cards of one suit.
+constexpr uint64_t suitBits(int suit) {
+    return static_cast<uint64_t>(kAllRanksMask) << (suit * kNumRanks);
+}
+
+/// The four cards of one rank.
+constexpr uint64_t rankBits(int rank) {
+    return (uint64_t{1} << rank) | (uint64_t{1} << (rank + kNumRanks)) |
+           (uint64_t{1} << (rank + 2 * kNumRanks)) | (uint64_t{1} << (rank + 3 * kNumRanks));
+}
+
+constexpr int popcount(uint64_t bits) { return __builtin_popcountll(bits); }
+
+/// Bits of `rankMask` (13-bit, deuce = bit 0) at which a five-card straight
+/// tops out. The wheel reports bit 3 (the five).
+constexpr uint16_t straightTops(uint16_t rankMask) {
+    // Fold the ace below the deuce so A-2-3-4-5 is just another run of five.
+    const uint32_t m = (static_cast<uint32_t>(rankMask) << 1) | ((rankMask >> kAce) & 1u);
+    const uint32_t runs = m & (m >> 1) & (m >> 2) & (m >> 3) & (m >> 4);
+    return static_cast<uint16_t>((runs << 3) & kAllRanksMask);
+}
+
+/// A set of cards stored as a 52-bit mask. Cheap to copy; pass it by value.
+class CardSet {
+public:
+    constexpr CardSet() = default;
+    constexpr explicit CardSet(uint64_t bits) : bits_(bits) {}
+    constexpr CardSet(Card card) : bits_(uint64_t{1} << card.id) {}
+
+    static constexpr CardSet fullDeck() { return CardSet(kFullDeckBits); }
+
+    constexpr uint64_t bits() const { return bits_; }
+    constexpr int size() const { return popcount(bits_); }
+    constexpr bool empty() const { return bits_ == 0; }
+
+    constexpr bool contains(Card card) const { return (bits_ >> card.id) & 1u; }
+    constexpr bool intersects(CardSet other) const { return (bits_ & other.bits_) != 0; }
+    constexpr bool containsAll(CardSet other) const { return (bits_ & other.bits_) == other.bits_; }
+
+    constexpr void add(Card card) { bits_ |= uint64_t{1} << card.id; }
+    constexpr void remove(Card card) { bits_ &= ~(uint64_t{1} << card.id); }
+
+    /// 13-bit rank mask of the cards held in one suit.
+    constexpr uint16_t suitMask(int suit) const {
+        return static_cast<uint16_t>((bits_ >> (suit * kNumRanks)) & kAllRanksMask);
+    }
+
+    /// 13-bit mask of the ranks present in any suit.
+    constexpr uint16_t rankMask() const {
+        return static_cast<uint16_t>(suitMask(kClubs) | suitMask(kDiamonds) | suitMask(kHearts) |
+                                     suitMask(kSpades));
+    }
+
+    /// Number of cards held in one suit.
+    constexpr int suitCount(int suit) const { return popcount(bits_ & suitBits(suit)); }
+
+    /// Suit holding five or more cards, or -1. At most one suit can when the set
+    /// has nine cards or fewer.
+    constexpr int flushSuit() const {
+        for (int s = 0; s < kNumSuits; ++s) {
+            if (suitCount(s) >= 5) return s;
+        }
+        return -1;
+    }
+
+    constexpr bool hasStraight() const { return straightTops(rankMask()) != 0; }
+
+    /// Lowest card in the set; the set must not be empty.
+    constexpr Card lowest() const { return Card(static_cast<uint8_t>(__builtin_ctzll(bits_))); }
+
+    /// Removes and returns the lowest card; the set must not be empty.
+    constexpr Card popLowest() {
+        const Card card = lowest();
+        bits_ &= bits_ - 1;
+        return card;
+    }
+
+    constexpr CardSet& operator|=(CardSet o) { bits_ |= o.bits_; return *this; }
+    constexpr CardSet& operator&=(CardSet o) { bits_ &= o.bits_; return *this; }
+    constexpr CardSet& operator-=(CardSet o) { bits_ &= ~o.bits_; return *this; }
+
+    friend constexpr CardSet operator|(CardSet a, CardSet b) { return CardSet(a.bits_ | b.bits_); }
+    friend constexpr CardSet operator&(CardSet a, CardSet b) { return CardSet(a.bits_ & b.bits_); }
+    friend constexpr CardSet operator-(CardSet a, CardSet b) { return CardSet(a.bits_ & ~b.bits_); }
+    /// Complement within the 52-card deck.
+    friend constexpr CardSet operator~(CardSet a) { return CardSet(~a.bits_ & kFullDeckBits); }
+    friend constexpr bool operator==(CardSet a, CardSet b) { return a.bits_ == b.bits_; }
+    friend constexpr bool operator!=(CardSet a, CardSet b) { return a.bits_ != b.bits_; }
+
+    /// Iterates cards in ascending id order.
+    class Iterator {
+    public:
+        constexpr explicit Iterator(uint64_t bits) : bits_(bits) {}
+        constexpr Card operator*() const { return Card(static_cast<uint8_t>(__builtin_ctzll(bits_))); }
+        constexpr Iterator& operator++() { bits_ &= bits_ - 1; return *this; }
+        constexpr bool operator!=(Iterator o) const { return bits_ != o.bits_; }
+
+    private:
+        uint64_t bits_;
+    };
+
+    constexpr Iterator begin() const { return Iterator(bits_); }
+    constexpr Iterator end() const { return Iterator(0); }
+
+private:
+    uint64_t bits_ = 0;
+};
+
+/// Cards in ascending id order, e.g. "2c7dAs".
+std::string toString(CardSet cards);
+
+/// Parses a run of cards such as "AsKd7h". Fails on malformed input or duplicates.
+bool parseCardSet(std::string_view text, CardSet& out);
+
+} // namespace poker
@@ -0,0 +1,158 @@
+#pragma once
+
+#include "poker/card_set.hpp"
+#include "poker/range.hpp"
+#include "poker/table.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace poker {
+
+class BucketMap;
+class ThreadPool;
+
+/// Bet sizing of a heads-up betting round, as fractions of the pot.
+struct BettingConfig {
+    Chips pot = 100;                     ///< already in the middle, shared equally
+    Chips stack = 400;                   ///< effective stack behind
+    std::vector<double> betSizes = {0.5, 1.0};
+    std::vector<double> raiseSizes = {1.0};
+    int maxBets = 3;                     ///< bets plus raises per round
+    bool allIn = true;                   ///< always offer all-in
+};
+
+/// Public betting tree of one heads-up round in flat arrays; node 0 is the
+/// root, player 0 acts first, and a node's children are contiguous.
+class BettingTree {
+public:
+    enum Kind : uint8_t { Decision, Fold, Showdown };
+
+    explicit BettingTree(const BettingConfig& config);
+
+    int size() const { return static_cast<int>(kind_.size()); }
+    Kind kind(int node) const { return kind_[node]; }
+    /// Player to act at a decision node, the folder at a fold node.
+    int player(int node) const { return player_[node]; }
+    int firstChild(int node) const { return firstChild_[node]; }
+    int childCount(int node) const { return childCount_[node]; }
+    /// Chips player p has put in during this round at the node.
+    Chips committed(int node, int p) const { return committed_[2 * node + p]; }
+    /// The action that leads to this node from its parent.
+    const Action& action(int node) const { return action_[node]; }
+    Chips pot() const { return pot_; }
+    int maxActions() const { return maxActions_; }
+    int depth() const { return depth_; }
+
+private:
+    int addNode(Kind kind, int player, Chips c0, Chips c1, const Action& action);
+    void expand(int node, Chips lastRaise, int bets, const BettingConfig& config, int level);
+
+    std::vector<Kind> kind_;
+    std::vector<uint8_t> player_;
+    std::vector<int> firstChild_;
+    std::vector<uint8_t> childCount_;
+    std::vector<Chips> committed_;
+    std::vector<Action> action_;
+    Chips pot_ = 0;
+    int maxActions_ = 0;
+    int depth_ = 0;
+};
+
+/// A heads-up game over a betting tree where each player holds one of a
+/// fixed number of private hand classes: individual combos for an exact
+/// subgame, or abstraction buckets.
+struct AbstractGame {
+    BettingTree tree;
+    int hands[2] = {0, 0};
+    /// Joint probability of each (player 0 hand, player 1 hand) pair, row
+    /// major with player 0's hand as the row; zero for impossible pairs.
+    std::vector<float> deal;
+    /// Player 0's share of the pot at showdown for each pair: 1, 0.5 or 0
+    /// between combos, an average between buckets.
+    std::vector<float> equity;
+    /// What the hand classes are, for reporting; empty sets for buckets.
+    std::vector<CardSet> cards[2];
+};
+
+/// River subgame: each player's hands are their range's combos that miss the
+/// board, dealt with the ranges' weights and card removal.
+/// Throws std::invalid_argument if the board is not five cards or a range is
+/// empty after removal.
+AbstractGame makeRiverGame(const Range& oop, const Range& ip, CardSet board,
+                           const BettingConfig& config);
+
+/// Subgame over a bucket map's classes: hand `b` of either player is bucket
+/// `b` of the board's street, dealt with the summed weights of the range
+/// combos in it. A bucket pair's equity is the weighted mean of its combo
+/// pairs' showdowns; on a flop or turn board each combo pair is averaged over
+/// every runout, so the game is one betting round checked down to the river.
+/// Throws std::invalid_argument if the board is not three to five cards, the
+/// map lacks its street or a range is empty after removal, and
+/// std::runtime_error if the map has no bucket for a combo.
+AbstractGame makeBucketedGame(const Range& oop, const Range& ip, CardSet board,
+                              const BucketMap& map, const BettingConfig& config);
+
+struct SolverOptions {
+    ThreadPool* pool = nullptr;      ///< shared pool when null
+    /// Refuse games whose tables and matrices would need more than this many
+    /// bytes (0 = no limit).
+    size_t maxMemoryBytes = 0;
+    /// Iterations before strategies start counting toward the average.
+    int averagingDelay = 0;
+};
+
+/// CFR+ over an AbstractGame.
+///
+/// Regrets and strategy sums are flat float arrays indexed by information
+/// set: a decision node's block holds hands x actions entries, hand-major, so
+/// one hand's row is contiguous. Iterations alternate players and walk the
+/// public tree once per update with vectors over the hand classes, so
+/// terminal values are matrix-vector products rather than per-deal work.
+///
+/// The traverser's hands are split into slices that run as separate tasks.
+/// A slice reads the opponent's strategy (fixed during the half-iteration)
+/// and writes only its own hands' rows, so updates need neither locks nor
+/// atomics and results do not depend on the thread count. Each worker's
+/// scratch vectors come from its own Arena, reset every task.
+class CfrSolver {
+public:
+    /// Throws std::invalid_argument if the game exceeds `maxMemoryBytes`.
+    explicit CfrSolver(const AbstractGame& game, const SolverOptions& options = {});
+
+    void iterate(int iterations);
+    int iterations() const { return iterations_; }
+
+    /// Average strategy at a decision node for one hand class; `out` gets
+    /// childCount(node) probabilities.
+    void averageStrategy(int node, int hand, float* out) const;
+
+    /// Best-response values against the average strategy (chips, relative to
+    /// the start of the round): how much each player could win by deviating,
+    /// averaged over both players. 0 at a Nash equilibrium.
+    double exploitability() const;
+
+    /// Expected chips player 0 wins if both play the average strategy.
+    double value() const;
+
+    size_t memoryBytes() const;
+
+private:
+    struct Scratch;
+
+    double traverse(int player, int mode, float* regrets, float* sums) const;
+    void update(int player);
+
+    const AbstractGame& game_;
+    ThreadPool& pool_;
+    SolverOptions options_;
+    std::vector<uint32_t> offset_;          ///< per node: start of its block
+    std::vector<float> regrets_;
+    std::vector<float> strategySum_;
+    std::vector<float> dealT_;              ///< deal transposed (player 1 rows)
+    std::vector<float> winDeal_[2];         ///< deal x own equity, per player
+    int iterations_ = 0;
+};
+
+} // namespace poker
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "poker/card.hpp"
+
+#include <cstdint>
+
+namespace poker {
+
+/// Largest subset size the binomial table covers (a full 7-card hand).
+inline constexpr int kMaxSubsetSize = 7;
+
+namespace detail {
+
+struct BinomialTable {
+    uint64_t value[kNumCards + 1][kMaxSubsetSize + 1] = {};
+};
+
+constexpr BinomialTable makeBinomialTable() {
+    BinomialTable t;
+    for (int n = 0; n <= kNumCards; ++n) {
+        t.value[n][0] = 1;
+        for (int k = 1; k <= kMaxSubsetSize && k <= n; ++k) {
+            t.value[n][k] = t.value[n - 1][k - 1] + (k < n ? t.value[n - 1][k] : 0);
+        }
+    }
+    return t;
+}
+
+inline constexpr BinomialTable kBinomials = makeBinomialTable();
+
+} // namespace detail
+
+/// C(n, k) for 0 <= n <= 52 and 0 <= k <= 7.
+constexpr uint64_t choose(int n, int k) {
+    return (k < 0 || k > n) ? 0 : detail::kBinomials.value[n][k];
+}
+
+/// Colex rank of a k-subset given as ascending positions: sum of C(p[i], i+1).
+constexpr uint64_t colexRank(const int* positions, int k) {
+    uint64_t index = 0;
+    for (int i = 0; i < k; ++i) index += choose(positions[i], i + 1);
+    return index;
+}
+
+/// Inverse of colexRank(): writes the ascending positions of the `index`-th
+/// k-subset in colex order.
+constexpr void colexUnrank(uint64_t index, int k, int* positions) {
+    for (int i = k; i >= 1; --i) {
+        int p = i - 1;
+        while (choose(p + 1, i) <= index) ++p;
+        positions[i - 1] = p;
+        index -= choose(p, i);
+    }
+}
+
+/// Steps ascending positions to the next k-subset in colex order, which is the
+/// subset whose colexRank() is one higher.
+constexpr void colexNext(int* positions, int k) {
+    int i = 0;
+    while (i + 1 < k && positions[i] + 1 == positions[i + 1]) {
+        positions[i] = i;
+        ++i;
+    }
+    if (k > 0) ++positions[i];
+}
+
+} // namespace poker
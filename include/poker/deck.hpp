@@ -0,0 +1,58 @@
+#pragma once
+
+#include "poker/card_set.hpp"
+
+#include <cstdint>
+
+namespace poker {
+
+/// Maps a uniform 64-bit draw onto [0, bound) with a single multiply.
+constexpr uint32_t boundedRandom(uint64_t draw, uint32_t bound) {
+    return static_cast<uint32_t>((static_cast<unsigned __int128>(draw) * bound) >> 64);
+}
+
+/// A deck that deals without replacement from the cards outside a dead set.
+///
+/// Dealing is a partial Fisher-Yates step over a fixed array, so a deal costs
+/// one random draw and one swap and the deck never allocates. `Rng` is any
+/// generator whose `operator()` returns uniform 64-bit values.
+class Deck {
+public:
+    explicit Deck(CardSet dead = CardSet()) { reset(dead); }
+
+    /// Restores every card except `dead`.
+    void reset(CardSet dead = CardSet()) {
+        remaining_ = 0;
+        for (Card card : ~dead) cards_[remaining_++] = card;
+        dealt_ = CardSet();
+    }
+
+    int remaining() const { return remaining_; }
+    /// Cards dealt since the last reset.
+    CardSet dealt() const { return dealt_; }
+
+    template <class Rng>
+    Card deal(Rng& rng) {
+        const uint32_t pick = boundedRandom(rng(), static_cast<uint32_t>(remaining_));
+        const Card card = cards_[pick];
+        cards_[pick] = cards_[--remaining_];
+        cards_[remaining_] = card;
+        dealt_.add(card);
+        return card;
+    }
+
+    /// Deals `count` cards and returns them as a set.
+    template <class Rng>
+    CardSet deal(Rng& rng, int count) {
+        CardSet hand;
+        for (int i = 0; i < count; ++i) hand.add(deal(rng));
+        return hand;
+    }
+
+private:
+    Card cards_[kNumCards];
+    int remaining_ = 0;
+    CardSet dealt_;
+};
+
+} // namespace poker
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "poker/card_set.hpp"
+#include "poker/range.hpp"
+#include "poker/variant.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace poker {
+
+class ThreadPool;
+
+/// Most players an equity query may involve (hero plus villains).
+inline constexpr int kMaxEquityPlayers = 10;
+
+/// Showdown outcome probabilities for the hero.
+///
+/// A tie is any showdown the hero shares; `equity` credits the hero with an
+/// equal share of the pot in each of those, so it is the hero's expected pot
+/// fraction. Deals are weighted by the product of the combo weights.
+struct EquityResult {
+    /// Showdowns evaluated (sampled or enumerated).
+    uint64_t trials = 0;
+    double win = 0.0;
+    double tie = 0.0;
+    double loss = 0.0;
+    double equity = 0.0;
+    /// Standard error of `equity`; 0 for exact results.
+    double stdError = 0.0;
+};
+
+struct MonteCarloOptions {
+    /// Upper bound on trials; the run may stop earlier, see `targetHalfWidth`.
+    uint64_t maxTrials = 1'000'000;
+    /// Stop once the confidence interval on equity is within +/- this value.
+    /// 0 runs all `maxTrials`, which makes the result depend only on `seed`.
+    double targetHalfWidth = 0.0;
+    /// Normal quantile of the confidence interval (1.96 = 95%).
+    double confidenceZ = 1.96;
+    /// Trials completed before the stopping rule is consulted.
+    uint64_t minTrials = 20'000;
+    uint64_t seed = 0x9e3779b97f4a7c15ull;
+    /// Cards known to be out of play (burned, folded, exposed).
+    CardSet dead;
+    /// Pool to run on; the shared pool when null.
+    ThreadPool* pool = nullptr;
+};
+
+/// Estimates the hero's equity against one or more villain ranges by Monte
+/// Carlo simulation on a partial board of 0..5 cards.
+///
+/// Trials are split into fixed-size tasks run on a work-stealing pool. Every
+/// task draws from its own generator derived from `seed` and the task index,
+/// and workers keep private counters that are merged at the end, so threads
+/// share nothing on the hot path and a full run gives the same answer for any
+/// thread count. A deal whose combos collide with each other is redrawn as a
+/// whole, so deals are sampled with the same weights `exactEquity()` uses.
+///
+/// The variant fixes the deck the board is completed from and the hand
+/// ranking; ranges hold two-card combos, so it is instantiated for Holdem and
+/// ShortDeck (where combos with cards outside the deck are never dealt).
+///
+/// Throws std::invalid_argument for empty ranges, too many players, a board
+/// of more than five cards, too few cards left outside the board and dead
+/// cards for every hand plus the rest of the board, or ranges that cannot be
+/// dealt together without sharing a card (e.g. AsAh against AsKd), which is
+/// decided once every trial of the run has failed to deal.
+template <class Variant = Holdem>
+EquityResult monteCarloEquity(const Range& hero, const std::vector<Range>& villains,
+                              CardSet board, const MonteCarloOptions& options = {});
+
+struct ExactOptions {
+    /// Cards known to be out of play (burned, folded, exposed).
+    CardSet dead;
+    /// Pool to run on; the shared pool when null.
+    ThreadPool* pool = nullptr;
+};
+
+/// Computes the hero's equity exactly by enumerating every non-colliding deal
+/// of the ranges and every completion of the board.
+///
+/// The flattened (deal, board) space is cut into fixed-size tasks; each task
+/// unranks its first board by colex index and then steps through boards in
+/// colex order, evaluating hands in batches with `evaluateBatch()`. Task
+/// totals are merged in task order, so the result is bit-identical for any
+/// thread count, and it is the expected value of `monteCarloEquity()`.
+///
+/// Cost grows with the product of the range sizes times C(remaining, missing
+/// board cards); use `exactShowdownCount()` to decide between the two modes.
+/// Throws std::invalid_argument like `monteCarloEquity()` (including when no
+/// deal of the ranges avoids a shared card), and also when the ranges yield
+/// more deals than an exact run is allowed to hold. Instantiated
+/// for Holdem and ShortDeck.
+template <class Variant = Holdem>
+EquityResult exactEquity(const Range& hero, const std::vector<Range>& villains, CardSet board,
+                         const ExactOptions& options = {});
+
+/// Number of showdowns `exactEquity()` would evaluate for these inputs.
+template <class Variant = Holdem>
+uint64_t exactShowdownCount(const Range& hero, const std::vector<Range>& villains, CardSet board,
+                            CardSet dead = CardSet());
+
+/// Monte Carlo equity of `hands[0]` against `hands[1..]` for any variant,
+/// including Omaha, whose four-card hands ranges cannot hold.
+///
+/// Each entry holds `Variant::kHoleCards` cards, or is empty for a player
+/// dealt a random hand from the deck each trial. Trials, tasks and seeding
+/// work as in `monteCarloEquity()`. Throws std::invalid_argument for a
+/// wrong-sized or overlapping hand, a card outside the variant's deck, fewer
+/// than two or more than kMaxEquityPlayers players, a board of more than
+/// five cards, or a deck too small for every hand plus the rest of the board
+/// (e.g. ten short-deck players with many dead cards). Instantiated for
+/// Holdem, ShortDeck and Omaha.
+template <class Variant>
+EquityResult handEquity(const std::vector<CardSet>& hands, CardSet board,
+                        const MonteCarloOptions& options = {});
+
+/// Exact counterpart of `handEquity()`: enumerates every completion of the
+/// board for fully known hands, in the task layout of `exactEquity()`.
+/// Throws std::invalid_argument like `handEquity()`, and for an empty hand.
+template <class Variant>
+EquityResult exactHandEquity(const std::vector<CardSet>& hands, CardSet board,
+                             const ExactOptions& options = {});
+
+} // namespace poker
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "poker/equity.hpp"
+#include "poker/isomorphism.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace poker {
+
+/// Concurrent cache of equity results keyed by canonical spot (SpotKey).
+///
+/// Entries live in one flat table of 64-byte slots split into shards; a key
+/// picks its shard from its high word and its home slot from its low word,
+/// probes a few slots linearly, and evicts the home slot when they are all
+/// taken. Each shard has its own lock, so threads working on different spots
+/// rarely contend.
+///
+/// The table can be backed by a file through a shared memory mapping: inserts
+/// land in the page cache as they happen and the file is the cache, so opening
+/// it again after a restart maps it back with every entry present, with no
+/// parsing or rebuilding. `flush()` forces it to disk. A slot is written under
+/// its shard lock, key last: it is emptied, filled in and only then given its
+/// key, so a process that dies mid-insert loses that entry but never pairs a
+/// key with another spot's result.
+class EquityCache {
+public:
+    /// In-memory cache with room for at least `capacity` entries.
+    explicit EquityCache(size_t capacity, unsigned shards = 64);
+
+    /// Cache backed by the file at `path`. An existing cache file is mapped as
+    /// is (its own capacity wins); a missing or empty file is created with room
+    /// for `capacity` entries. Throws std::runtime_error if the file cannot be
+    /// opened or mapped, or exists but is not a cache file.
+    EquityCache(const std::string& path, size_t capacity, unsigned shards = 64);
+    ~EquityCache();
+
+    EquityCache(const EquityCache&) = delete;
+    EquityCache& operator=(const EquityCache&) = delete;
+
+    bool lookup(const SpotKey& key, EquityResult& out) const;
+    void insert(const SpotKey& key, const EquityResult& result);
+
+    /// Writes dirty pages of a file-backed cache to disk; no-op in memory.
+    bool flush();
+
+    /// Writes a snapshot to `path` that the file constructor can open, via a
+    /// temporary file and a rename so readers never see half a file.
+    bool save(const std::string& path) const;
+
+    size_t size() const;
+    size_t capacity() const { return static_cast<size_t>(shardCount_) * slotsPerShard_; }
+    bool persistent() const { return fd_ >= 0; }
+    uint64_t hits() const;
+    uint64_t misses() const;
+
+private:
+    struct Header;
+    struct Slot;
+    struct alignas(64) Shard {
+        mutable std::mutex lock;
+        size_t used = 0;
+        mutable uint64_t hits = 0;
+        mutable uint64_t misses = 0;
+    };
+
+    void layout(size_t capacity, unsigned shards);
+    void map(bool existing);
+    Slot* shardSlots(unsigned shard) const;
+
+    unsigned shardCount_ = 0;
+    size_t slotsPerShard_ = 0;
+    size_t bytes_ = 0;
+    void* base_ = nullptr;
+    int fd_ = -1;
+    std::unique_ptr<Shard[]> shards_;
+};
+
+/// `exactEquity()` through a cache: isomorphic queries share one entry.
+EquityResult cachedExactEquity(EquityCache& cache, const Range& hero,
+                               const std::vector<Range>& villains, CardSet board,
+                               const ExactOptions& options = {});
+
+/// `monteCarloEquity()` through a cache. Entries are keyed by the trial budget
+/// and stopping rule but not the seed, so a cached answer stands in for any
+/// seed's.
+EquityResult cachedMonteCarloEquity(EquityCache& cache, const Range& hero,
+                                    const std::vector<Range>& villains, CardSet board,
+                                    const MonteCarloOptions& options = {});
+
+} // namespace poker
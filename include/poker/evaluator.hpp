@@ -0,0 +1,190 @@
+#pragma once
+
+#include "poker/card.hpp"
+#include "poker/card_set.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace poker {
+
+/// Strength of a poker hand under one ranking: 1 is the weakest five-card hand
+/// and `numHandValues<Ranking>()` the strongest (7462, a royal flush, under
+/// the standard ranking). Higher values win; equal values split. 0 is never
+/// produced.
+using HandValue = uint16_t;
+
+inline constexpr int kNumHandValues = 7462;
+
+enum class HandCategory : uint8_t {
+    HighCard,
+    OnePair,
+    TwoPair,
+    ThreeOfAKind,
+    Straight,
+    Flush,
+    FullHouse,
+    FourOfAKind,
+    StraightFlush,
+};
+
+inline constexpr int kNumHandCategories = 9;
+
+/// Hand-ranking rules. The evaluator builds one set of lookup tables per
+/// ranking type, so every ranking gets its own inlined `evaluate<Ranking>()`
+/// and nothing is decided at run time.
+///
+/// `kLowestRank` is the lowest rank in the deck, which also fixes the wheel
+/// (the ace plays below the four lowest ranks). `kOrder` lists the categories
+/// from weakest to strongest and `kClasses` the number of distinct five-card
+/// hands in each, in the same order; the table builder checks both.
+struct StandardRanking {
+    static constexpr int kLowestRank = kTwo;
+    static constexpr HandCategory kOrder[kNumHandCategories] = {
+        HandCategory::HighCard, HandCategory::OnePair,  HandCategory::TwoPair,
+        HandCategory::ThreeOfAKind, HandCategory::Straight, HandCategory::Flush,
+        HandCategory::FullHouse, HandCategory::FourOfAKind, HandCategory::StraightFlush,
+    };
+    static constexpr uint16_t kClasses[kNumHandCategories] = {1277, 2860, 858, 858, 10, 1277, 156, 156, 10};
+};
+
+/// Short-deck (six-plus) Hold'em: deuces through fives are removed, A-6-7-8-9
+/// is the lowest straight, and a flush beats a full house.
+struct ShortDeckRanking {
+    static constexpr int kLowestRank = kSix;
+    static constexpr HandCategory kOrder[kNumHandCategories] = {
+        HandCategory::HighCard, HandCategory::OnePair,  HandCategory::TwoPair,
+        HandCategory::ThreeOfAKind, HandCategory::Straight, HandCategory::FullHouse,
+        HandCategory::Flush, HandCategory::FourOfAKind, HandCategory::StraightFlush,
+    };
+    static constexpr uint16_t kClasses[kNumHandCategories] = {120, 504, 252, 252, 6, 72, 120, 72, 6};
+};
+
+/// Number of distinct hand values under a ranking.
+template <class Ranking>
+constexpr int numHandValues() {
+    int total = 0;
+    for (uint16_t classes : Ranking::kClasses) total += classes;
+    return total;
+}
+
+/// Category of a hand value, derived from the ranking's fixed class layout.
+template <class Ranking = StandardRanking>
+constexpr HandCategory handCategory(HandValue value) {
+    int top = 0;
+    for (int i = 0; i + 1 < kNumHandCategories; ++i) {
+        top += Ranking::kClasses[i];
+        if (value <= top) return Ranking::kOrder[i];
+    }
+    return Ranking::kOrder[kNumHandCategories - 1];
+}
+
+static_assert(numHandValues<StandardRanking>() == kNumHandValues, "standard class counts");
+static_assert(handCategory(1277) == HandCategory::HighCard && handCategory(5863) == HandCategory::Straight &&
+                  handCategory(7453) == HandCategory::StraightFlush,
+              "standard category boundaries");
+
+const char* categoryName(HandCategory category);
+
+namespace detail {
+
+/// Every card adds this to the rank key, so the key also encodes the number of
+/// cards and 5-, 6- and 7-card rank multisets never share a key.
+inline constexpr uint32_t kCardCountUnit = 1u << 23;
+
+inline constexpr int kRankHashBucketBits = 14;
+inline constexpr uint32_t kRankHashBuckets = 1u << kRankHashBucketBits;
+inline constexpr uint32_t kRankHashSlots = 1u << 17;
+
+/// Lookup tables behind the evaluator.
+///
+/// Non-flush hands are identified by the sum of per-rank keys, which is unique
+/// for every rank multiset of up to seven cards. That key is mapped through a
+/// hash-and-displace perfect hash into `rankValue`. Flushes are looked up
+/// directly by the 13-bit rank mask of the flush suit.
+struct EvalTables {
+    uint32_t suitKey[1 << kNumRanks];            // summed card keys of one 13-bit suit lane
+    // The 16-bit tables carry one spare entry so the batch evaluator's 32-bit
+    // gathers stay in bounds at the last index.
+    HandValue flushValue[(1 << kNumRanks) + 1];  // best flush for masks with >= 5 bits, else 0
+    uint32_t displacement[kRankHashBuckets];
+    HandValue rankValue[kRankHashSlots + 1];
+    uint32_t hashMultiplier;
+};
+
+/// Builds the tables for one ranking on first use. Prefer `evalTables()`.
+template <class Ranking>
+const EvalTables& buildEvalTables();
+
+template <class Ranking = StandardRanking>
+inline const EvalTables& evalTables() {
+    static const EvalTables& tables = buildEvalTables<Ranking>();
+    return tables;
+}
+
+/// Scrambles a rank key. Only 32-bit multiplies are used so the batch
+/// evaluator can run the same hash in vector lanes.
+inline uint32_t mixRankKey(uint32_t key, uint32_t multiplier) {
+    uint32_t h = key * multiplier;
+    h ^= h >> 15;
+    return h * 0x2c1b3c6du;
+}
+
+inline HandValue lookupRankKey(const EvalTables& t, uint32_t key) {
+    const uint32_t h = mixRankKey(key, t.hashMultiplier);
+    const uint32_t bucket = h >> (32 - kRankHashBucketBits);
+    return t.rankValue[(h ^ t.displacement[bucket]) & (kRankHashSlots - 1)];
+}
+
+} // namespace detail
+
+/// Forces the lookup tables to be built now instead of on the first evaluation.
+template <class Ranking = StandardRanking>
+inline void initEvaluator() { (void)detail::evalTables<Ranking>(); }
+
+/// Evaluates the best five-card hand in a set of 5, 6 or 7 cards.
+///
+/// Cost is four suit-lane lookups plus a single rank-table lookup; nothing is
+/// sorted and nothing is allocated. Returning the flush as soon as one exists
+/// is right under every ranking: seven cards cannot hold both a flush and a
+/// full house or quads.
+template <class Ranking = StandardRanking>
+inline HandValue evaluate(CardSet cards) {
+    const detail::EvalTables& t = detail::evalTables<Ranking>();
+    const uint16_t clubs = cards.suitMask(kClubs);
+    const uint16_t diamonds = cards.suitMask(kDiamonds);
+    const uint16_t hearts = cards.suitMask(kHearts);
+    const uint16_t spades = cards.suitMask(kSpades);
+    // Lanes with fewer than five cards map to 0, and at most one lane of a
+    // 7-card set can hold five, so OR-ing the four lookups is branch-free.
+    const HandValue flush = t.flushValue[clubs] | t.flushValue[diamonds] |
+                            t.flushValue[hearts] | t.flushValue[spades];
+    if (flush != 0) return flush;
+    return detail::lookupRankKey(
+        t, t.suitKey[clubs] + t.suitKey[diamonds] + t.suitKey[hearts] + t.suitKey[spades]);
+}
+
+/// Evaluates the best five-card hand among 5, 6 or 7 distinct cards.
+inline HandValue evaluate(const Card* cards, int count) {
+    CardSet set;
+    for (int i = 0; i < count; ++i) set.add(cards[i]);
+    return evaluate(set);
+}
+
+/// Evaluates `count` 5..7-card sets into `out`, with results identical to
+/// `evaluate<Ranking>()`. Builds with POKER_ENABLE_AVX2 run eight hands per
+/// step with vector gathers when the CPU supports AVX2; otherwise this is a
+/// scalar loop. Instantiated for StandardRanking and ShortDeckRanking.
+template <class Ranking = StandardRanking>
+void evaluateBatch(const CardSet* hands, HandValue* out, size_t count);
+
+/// True when `evaluateBatch()` runs the AVX2 kernel on this machine.
+bool batchEvaluatorUsesAvx2();
+
+template <int N>
+inline HandValue evaluate(const Card (&cards)[N]) {
+    static_assert(N >= 5 && N <= 7, "the evaluator ranks 5, 6 or 7 cards");
+    return evaluate(cards, N);
+}
+
+} // namespace poker
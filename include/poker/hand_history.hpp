@@ -0,0 +1,219 @@
+#pragma once
+
+#include "poker/table.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace poker {
+
+/// Hand-level facts of one recorded hand. Seats that were not dealt in have
+/// zero stacks and empty holes; an empty hole on a dealt seat means the cards
+/// are unknown.
+struct HandHeader {
+    uint64_t handNumber = 0;
+    uint32_t tableId = 0;
+    uint8_t seats = 0;
+    int8_t button = -1;
+    Street finalStreet = Street::Preflop;  ///< street the hand ended on
+    Chips smallBlind = 0;
+    Chips bigBlind = 0;
+    Chips ante = 0;
+    uint16_t dealt = 0;                    ///< seat bitmask
+    Chips startingStack[kMaxSeats] = {};
+    CardSet hole[kMaxSeats];
+    CardSet board;
+};
+
+/// Binary hand-history format.
+///
+/// A file is an 8-byte header ("PKHH", version, padding) followed by records.
+/// Each record is a varint byte length and a body:
+///
+///   varint hand number, varint table id,
+///   byte seats | final street << 4, byte button,
+///   varint small blind, big blind, ante, u16 dealt-seat mask,
+///   per dealt seat: varint starting stack, two card bytes (0xff = unknown),
+///   byte board size, board card bytes, varint event count, events.
+///
+/// An event is one byte of type << 4 | (seat + 1), then for chip-moving events
+/// a varint of amount << 1 | all-in, and for WinPot one pot byte. A typical
+/// 6-max hand is well under 100 bytes.
+namespace hand_history {
+
+inline constexpr char kMagic[4] = {'P', 'K', 'H', 'H'};
+inline constexpr uint8_t kVersion = 1;
+inline constexpr size_t kFileHeaderBytes = 8;
+
+/// Upper bound on the encoded size of a hand with `events` events.
+constexpr size_t maxRecordBytes(size_t events) { return 10 + 128 + kMaxSeats * 12 + 16 + events * 12; }
+
+/// Encodes a header and events (with the length prefix) into `out`, which
+/// must hold maxRecordBytes(events.size()). Returns the bytes written.
+size_t encode(const HandHeader& header, const HandEvent* events, size_t count, uint8_t* out);
+
+/// Offset just past the record that starts at `offset` in a file image of
+/// `size` bytes, found from the length prefix alone; 0 if the record is
+/// incomplete. Lets callers split a file into chunks without decoding it.
+size_t recordEnd(const uint8_t* file, size_t size, size_t offset);
+
+} // namespace hand_history
+
+/// The header of the hand `table` just finished.
+HandHeader handHeader(const Table& table, uint32_t tableId);
+
+/// Reads the events of one record without copying them out of the file.
+class EventReader {
+public:
+    EventReader() = default;
+    EventReader(const uint8_t* data, const uint8_t* end, uint32_t count, Street finalStreet)
+        : data_(data), end_(end), remaining_(count), finalStreet_(finalStreet) {}
+
+    /// Decodes the next event; false at the end or on malformed bytes.
+    bool next(HandEvent& event);
+    uint32_t remaining() const { return remaining_; }
+
+private:
+    const uint8_t* data_ = nullptr;
+    const uint8_t* end_ = nullptr;
+    uint32_t remaining_ = 0;
+    Street finalStreet_ = Street::Preflop;
+    Street street_ = Street::Preflop;
+};
+
+/// One record in a mapped file: the decoded header plus a cursor over the
+/// still-encoded events.
+struct HandView {
+    HandHeader header;
+    uint32_t eventCount = 0;
+    const uint8_t* eventData = nullptr;
+    const uint8_t* end = nullptr;
+
+    EventReader events() const { return EventReader(eventData, end, eventCount, header.finalStreet); }
+};
+
+/// Decodes a record body (without its length prefix).
+bool decodeHand(const uint8_t* data, size_t size, HandView& out);
+
+/// Decodes the record that starts at `offset` in a file image of `size`
+/// bytes. Returns the offset just past it, or 0 if it is incomplete or
+/// malformed.
+size_t decodeRecord(const uint8_t* file, size_t size, size_t offset, HandView& out);
+
+/// Appends hands to a history file through a large in-memory buffer that is
+/// written out with one system call when full, so logging costs a few
+/// hundred nanoseconds per hand and no allocation after construction.
+class HandHistoryWriter {
+public:
+    /// Opens `path` for appending (creating it with a file header when it is
+    /// new or empty). Throws std::runtime_error if it cannot be opened or is
+    /// not a hand-history file.
+    explicit HandHistoryWriter(const std::string& path, size_t bufferBytes = 1 << 20);
+    ~HandHistoryWriter();
+
+    HandHistoryWriter(const HandHistoryWriter&) = delete;
+    HandHistoryWriter& operator=(const HandHistoryWriter&) = delete;
+
+    /// Records the hand `table` just finished. Returns false on a write error.
+    /// After the first error the writer is failed: every later append and
+    /// flush returns false without writing, and the destructor writes nothing,
+    /// so the file keeps what reached it and is never extended past a
+    /// partial write.
+    bool append(const Table& table, uint32_t tableId);
+    bool append(const HandHeader& header, const HandEvent* events, size_t count);
+
+    /// Writes buffered hands to the file.
+    bool flush();
+
+    bool failed() const { return failed_; }
+    uint64_t hands() const { return hands_; }
+    /// Bytes that reached the file, including the partial write that failed.
+    uint64_t bytesWritten() const { return bytes_; }
+
+private:
+    bool reserve(size_t bytes);
+
+    int fd_ = -1;
+    std::vector<uint8_t> buffer_;
+    size_t used_ = 0;
+    uint64_t hands_ = 0;
+    uint64_t bytes_ = 0;
+    bool failed_ = false;
+};
+
+/// Maps a history file read-only and walks its records in place.
+class HandHistoryReader {
+public:
+    /// Throws std::runtime_error if the file cannot be mapped or has the wrong
+    /// header.
+    explicit HandHistoryReader(const std::string& path);
+    ~HandHistoryReader();
+
+    HandHistoryReader(const HandHistoryReader&) = delete;
+    HandHistoryReader& operator=(const HandHistoryReader&) = delete;
+
+    /// Record bodies, found by hopping over length prefixes. Iteration stops
+    /// at the first truncated or malformed record; corrupt() reports that.
+    class Iterator {
+    public:
+        Iterator(const HandHistoryReader* reader, const uint8_t* at) : reader_(reader), at_(at) { load(); }
+        const HandView& operator*() const { return view_; }
+        const HandView* operator->() const { return &view_; }
+        Iterator& operator++() {
+            at_ = next_;
+            load();
+            return *this;
+        }
+        bool operator!=(const Iterator& o) const { return at_ != o.at_; }
+        /// Byte offset of the current record in the file.
+        size_t offset() const { return static_cast<size_t>(at_ - reader_->data_); }
+
+    private:
+        void load();
+
+        const HandHistoryReader* reader_;
+        const uint8_t* at_;
+        const uint8_t* next_ = nullptr;
+        HandView view_;
+    };
+
+    Iterator begin() const { return Iterator(this, data_ + hand_history::kFileHeaderBytes); }
+    Iterator end() const { return Iterator(this, nullptr); }
+
+    /// Iterator starting at a record boundary previously reported by offset().
+    Iterator at(size_t offset) const { return Iterator(this, data_ + offset); }
+
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool corrupt() const { return corrupt_; }
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    mutable bool corrupt_ = false;
+};
+
+/// Debugging form of one hand, e.g.
+///
+///   hand 7 table 2 seats 6 button 3 blinds 1/2 ante 0 ends flop
+///   seat 0 200 AsKd
+///   board Kc7h2h
+///   4 small-blind 1
+///   5 big-blind 2
+///   0 raise 6
+///   - flop
+///   0 win 15 pot 0
+///   end
+std::string toText(const HandView& hand);
+
+/// Converts a whole binary file to text, one hand after another.
+bool historyToText(const std::string& binaryPath, const std::string& textPath);
+
+/// Converts text produced by historyToText() (possibly hand-edited) back to
+/// a binary file. Returns false on I/O errors or malformed text.
+bool textToHistory(const std::string& textPath, const std::string& binaryPath);
+
+} // namespace poker
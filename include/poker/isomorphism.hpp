@@ -0,0 +1,69 @@
+#pragma once
+
+#include "poker/card_set.hpp"
+#include "poker/range.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace poker {
+
+/// Number of ways to relabel the four suits.
+inline constexpr int kNumSuitPermutations = 24;
+
+/// A relabeling of suits: cards of suit s become suit `to[s]`. Poker hands
+/// that differ only by such a relabeling have identical equities.
+struct SuitPermutation {
+    uint8_t to[kNumSuits] = {kClubs, kDiamonds, kHearts, kSpades};
+
+    constexpr Card apply(Card card) const { return Card(card.rank(), to[card.suit()]); }
+
+    /// Moves whole 13-bit suit lanes, so it costs four shifts.
+    constexpr CardSet apply(CardSet cards) const {
+        uint64_t out = 0;
+        for (int s = 0; s < kNumSuits; ++s) {
+            out |= uint64_t{cards.suitMask(s)} << (to[s] * kNumRanks);
+        }
+        return CardSet(out);
+    }
+
+    Range apply(const Range& range) const;
+
+    constexpr SuitPermutation inverse() const {
+        SuitPermutation inv;
+        for (int s = 0; s < kNumSuits; ++s) inv.to[to[s]] = static_cast<uint8_t>(s);
+        return inv;
+    }
+};
+
+/// All suit permutations in lexicographic order of `to`; index 0 is the
+/// identity.
+const SuitPermutation& suitPermutation(int index);
+
+/// The suit relabeling of `cards` with the smallest bit pattern, e.g. every
+/// monotone flop of the same ranks maps to one set. If `used` is given it
+/// receives a permutation that produces the result.
+CardSet canonicalCards(CardSet cards, SuitPermutation* used = nullptr);
+
+/// 128-bit identity of an equity query up to suit relabeling. Never all zero.
+struct SpotKey {
+    uint64_t hi = 0;
+    uint64_t lo = 0;
+
+    friend bool operator==(const SpotKey& a, const SpotKey& b) { return a.hi == b.hi && a.lo == b.lo; }
+    friend bool operator!=(const SpotKey& a, const SpotKey& b) { return !(a == b); }
+};
+
+/// Key of the query "hero against villains on board with dead cards removed",
+/// equal for any two queries that differ by a suit relabeling or by the order
+/// of the villains. `salt` separates otherwise equal queries asked with
+/// different settings.
+///
+/// The board and dead cards pick the candidate relabelings (those giving the
+/// smallest board, then dead set); the ranges are hashed under each candidate
+/// and the smallest digest wins. Preflop that is all 24 relabelings, with a
+/// board it is usually one or two.
+SpotKey canonicalSpotKey(const Range& hero, const std::vector<Range>& villains, CardSet board,
+                         CardSet dead = CardSet(), uint64_t salt = 0);
+
+} // namespace poker
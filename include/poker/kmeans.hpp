@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace poker {
+
+class ThreadPool;
+
+/// Points per row are padded to a multiple of this many floats, the width
+/// of one AVX2 register, so distance kernels never need a scalar tail.
+inline constexpr int kKMeansLanes = 8;
+
+constexpr int kMeansStride(int dims) { return (dims + kKMeansLanes - 1) / kKMeansLanes * kKMeansLanes; }
+
+struct KMeansOptions {
+    int clusters = 8;
+    int maxIterations = 25;
+    /// k-means++ seeding runs on at most this many sampled points.
+    size_t seedSample = 16384;
+    uint64_t seed = 0x6b6d65616e73u;
+    ThreadPool* pool = nullptr;   ///< shared pool when null
+};
+
+struct KMeansResult {
+    int stride = 0;
+    std::vector<float> centroids;       ///< clusters x stride
+    std::vector<uint32_t> assignment;   ///< cluster of each point
+    double inertia = 0;                 ///< sum of squared distances
+    int iterations = 0;
+};
+
+/// Lloyd's k-means on `count` points of `stride` floats each (see
+/// kMeansStride(); padding must be zero). Seeds with k-means++ on a sample.
+///
+/// Assignment runs in parallel over fixed blocks of points; each block
+/// accumulates its own centroid sums, which are merged in block order, so
+/// the result is the same for any thread count. The nearest-centroid kernel
+/// uses AVX2 when the build enables it and the CPU supports it. An empty
+/// cluster is reseeded with the point farthest from its centroid.
+///
+/// Throws std::invalid_argument if there are fewer points than clusters.
+KMeansResult kMeans(const float* points, size_t count, int stride, const KMeansOptions& options);
+
+/// For each point, the nearest of `k` centroids and the squared distance.
+void nearestCentroids(const float* points, size_t count, const float* centroids, int k,
+                      int stride, uint32_t* nearest, float* distance);
+
+/// True when nearestCentroids() runs the AVX2 kernel on this machine.
+bool kMeansUsesAvx2();
+
+} // namespace poker
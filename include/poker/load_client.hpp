@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace poker {
+
+struct LoadClientConfig {
+    std::string address = "127.0.0.1";
+    uint16_t port = 0;
+    int connections = 1000;
+    unsigned threads = 1;         ///< event loops the connections are split over
+    double seconds = 5;           ///< measurement time after every connection has joined
+    uint64_t seed = 0x10adc11e;
+    /// How often a simulated player folds or raises instead of checking or
+    /// calling; the rest of the time it keeps the hand going.
+    double foldProbability = 0.05;
+    double raiseProbability = 0.10;
+};
+
+struct LoadReport {
+    int connected = 0;
+    uint64_t actions = 0;         ///< actions whose echo was received in the window
+    uint64_t hands = 0;           ///< HandEnd messages received in the window
+    uint64_t errors = 0;          ///< connections lost or protocol errors
+    double seconds = 0;
+    /// Action latency: from writing an Act to reading the server's Event for
+    /// it, in microseconds.
+    double p50Micros = 0;
+    double p99Micros = 0;
+    double p999Micros = 0;
+    double maxMicros = 0;
+
+    double actionsPerSecond() const { return seconds > 0 ? actions / seconds : 0; }
+};
+
+/// Load generator for GameServer: opens `connections` TCP connections, joins
+/// each to a table and answers every ActionRequest at once with a random
+/// legal action, recording how long the server takes to confirm it.
+///
+/// Connections are spread over `threads` epoll loops, each reading and
+/// writing its sockets without blocking. Latency is only recorded during
+/// the measurement window, which starts once every connection has been
+/// welcomed. Throws std::runtime_error if connecting fails.
+LoadReport runLoadClient(const LoadClientConfig& config);
+
+} // namespace poker
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+namespace poker {
+
+/// Per-phase hot-path timers and event counters.
+///
+/// Instrumentation is written with the POKER_PROFILE_SCOPE and
+/// POKER_PROFILE_COUNT macros, which expand to nothing unless the build
+/// defines POKER_PROFILE (CMake option POKER_ENABLE_PROFILING, off by
+/// default). Release builds therefore carry no timer code at all. When
+/// enabled, each thread accumulates into its own slots, registered once and
+/// kept for the life of the process, so recording is two relaxed stores and
+/// totals survive the thread.
+namespace profile {
+
+enum class Phase : uint8_t {
+    EvaluateBatch,
+    EquityMonteCarlo,
+    EquityExact,
+    TableStartHand,
+    TableAct,
+    SimulationShard,
+    HistoryAppend,
+    CfrIterate,
+    CfrTraverse,
+    KMeansAssign,
+    AbstractionFeatures,
+    ServerBatch,
+    Count,
+};
+
+enum class Counter : uint8_t {
+    HandsEvaluated,
+    EquityTrials,
+    HandsDealt,
+    Actions,
+    HistoryBytes,
+    CfrIterations,
+    KMeansDistances,
+    ServerMessages,
+    Count,
+};
+
+inline constexpr int kNumPhases = static_cast<int>(Phase::Count);
+inline constexpr int kNumCounters = static_cast<int>(Counter::Count);
+
+const char* name(Phase phase);
+const char* name(Counter counter);
+
+/// True when the library was built with POKER_PROFILE.
+bool enabled();
+
+/// Zeroes every thread's totals. Call while no instrumented code runs.
+void reset();
+
+/// Writes one `profile=<phase> calls=... seconds=...` line per phase and one
+/// `counter=<name> value=...` line per counter that saw any activity.
+/// Writes nothing when profiling is compiled out.
+void report(FILE* out);
+
+#if defined(POKER_PROFILE)
+
+void record(Phase phase, uint64_t nanoseconds);
+void add(Counter counter, uint64_t amount);
+
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Phase phase) : phase_(phase), start_(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer() {
+        const auto elapsed = std::chrono::steady_clock::now() - start_;
+        record(phase_, static_cast<uint64_t>(
+                           std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Phase phase_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+#define POKER_PROFILE_CONCAT_(a, b) a##b
+#define POKER_PROFILE_CONCAT(a, b) POKER_PROFILE_CONCAT_(a, b)
+/// Times the rest of the enclosing scope as `phase`.
+#define POKER_PROFILE_SCOPE(phase) \
+    ::poker::profile::ScopedTimer POKER_PROFILE_CONCAT(pokerProfileTimer, __LINE__)(::poker::profile::Phase::phase)
+/// Adds `amount` to `counter`.
+#define POKER_PROFILE_COUNT(counter, amount) \
+    ::poker::profile::add(::poker::profile::Counter::counter, static_cast<uint64_t>(amount))
+
+#else
+
+#define POKER_PROFILE_SCOPE(phase) static_cast<void>(0)
+#define POKER_PROFILE_COUNT(counter, amount) static_cast<void>(0)
+
+#endif
+
+} // namespace profile
+} // namespace poker
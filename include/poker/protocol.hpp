@@ -0,0 +1,58 @@
+#pragma once
+
+#include "poker/card_set.hpp"
+#include "poker/table.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace poker {
+
+/// Wire format between GameServer and its clients.
+///
+/// Every message is one frame: a 2-byte little-endian body length, then the
+/// body, which starts with a type byte. Integers are varints, signed ones
+/// zig-zag encoded, cards are single id bytes and card sets are varints of
+/// their bits, so a typical frame is 3 to 12 bytes.
+namespace protocol {
+
+enum class MessageType : uint8_t {
+    // Client to server.
+    Join = 1,         ///< take a seat at any table with room
+    Act = 2,          ///< `action`, answering the last ActionRequest
+    Leave = 3,
+    // Server to client.
+    Welcome = 16,     ///< `table`, `seat`
+    HandStart = 17,   ///< `handNumber`, `seat` (the button), `cards` (the receiver's hole cards)
+    ActionRequest = 18, ///< `legal`, `cards` (the board)
+    Event = 19,       ///< `event`, one entry of the hand's log
+    HandEnd = 20,     ///< `handNumber`, `amount` (receiver's net chips), `cards` (final board)
+};
+
+/// Decoded message; only the fields listed for its type are meaningful.
+struct Message {
+    MessageType type = MessageType::Join;
+    uint8_t seat = 0;
+    uint32_t table = 0;
+    uint64_t handNumber = 0;
+    CardSet cards;
+    Chips amount = 0;
+    Action action;
+    LegalActions legal;
+    HandEvent event{};
+};
+
+inline constexpr size_t kFrameHeaderBytes = 2;
+/// Upper bound on an encoded frame.
+inline constexpr size_t kMaxFrameBytes = 64;
+
+/// Writes the frame for `message` to `out` (at least kMaxFrameBytes) and
+/// returns its size.
+size_t encode(const Message& message, uint8_t* out);
+
+/// Decodes the frame at the start of `data`. Returns its size, 0 if `size`
+/// bytes do not yet hold a whole frame, or -1 if the frame is malformed.
+long decode(const uint8_t* data, size_t size, Message& out);
+
+} // namespace protocol
+} // namespace poker
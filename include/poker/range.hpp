@@ -0,0 +1,116 @@
+#pragma once
+
+#include "poker/card_set.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace poker {
+
+/// Number of distinct two-card starting hands, C(52, 2).
+inline constexpr int kNumCombos = 1326;
+
+/// Dense index of the two-card hand {a, b}: the colex rank of the pair, so
+/// combos are ordered by their higher card id, then their lower one.
+constexpr int comboIndex(Card a, Card b) {
+    const int lo = a.id < b.id ? a.id : b.id;
+    const int hi = a.id < b.id ? b.id : a.id;
+    return hi * (hi - 1) / 2 + lo;
+}
+
+namespace detail {
+
+struct ComboMasks {
+    uint64_t bits[kNumCombos] = {};
+    /// The same masks split into 32-bit halves, so the blocker test is plain
+    /// 32-bit AND/compare that vectorizes without 64-bit lane compares.
+    uint32_t low[kNumCombos] = {};
+    uint32_t high[kNumCombos] = {};
+};
+
+constexpr ComboMasks makeComboMasks() {
+    ComboMasks t;
+    for (int hi = 1; hi < kNumCards; ++hi) {
+        for (int lo = 0; lo < hi; ++lo) {
+            const int index = comboIndex(Card(uint8_t(lo)), Card(uint8_t(hi)));
+            t.bits[index] = (uint64_t{1} << lo) | (uint64_t{1} << hi);
+            t.low[index] = static_cast<uint32_t>(t.bits[index]);
+            t.high[index] = static_cast<uint32_t>(t.bits[index] >> 32);
+        }
+    }
+    return t;
+}
+
+/// Card mask of every combo index; the blocker mask used by range filtering.
+inline constexpr ComboMasks kComboMasks = makeComboMasks();
+
+} // namespace detail
+
+/// The two cards of a combo index.
+constexpr CardSet comboCards(int index) { return CardSet(detail::kComboMasks.bits[index]); }
+
+/// A weighted set of two-card starting hands, stored as one weight per combo
+/// index so range arithmetic and card removal are flat passes over a fixed
+/// array.
+class Range {
+public:
+    struct Combo {
+        CardSet cards;
+        float weight;
+    };
+
+    Range() = default;
+
+    /// Range holding a single known hand.
+    static Range single(CardSet hand) {
+        Range range;
+        range.set(hand);
+        return range;
+    }
+
+    /// Sets the weight of a two-card hand; 0 removes it. Throws
+    /// std::invalid_argument if `hand` is not exactly two cards.
+    void set(CardSet hand, float weight = 1.0f);
+    void set(int index, float weight) { weights_[index] = weight > 0.0f ? weight : 0.0f; }
+
+    float weight(int index) const { return weights_[index]; }
+    float weight(CardSet hand) const;
+    const float* weights() const { return weights_; }
+
+    /// Zeroes every combo that shares a card with `dead`.
+    void removeBlocked(CardSet dead) { removeBlocked(dead, weights_); }
+    /// Writes the weights with combos touching `dead` zeroed to `out`, which
+    /// holds kNumCombos floats and may be weights().
+    void removeBlocked(CardSet dead, float* out) const;
+
+    /// The combos with positive weight that miss `dead`, in index order.
+    std::vector<Combo> combos(CardSet dead = CardSet()) const;
+
+    /// Number of combos with positive weight, and the sum of their weights.
+    int size() const;
+    double totalWeight() const;
+    bool empty() const { return size() == 0; }
+
+private:
+    alignas(64) float weights_[kNumCombos] = {};
+};
+
+/// Parses standard range notation into `out`. Entries are separated by commas
+/// or spaces and later entries overwrite earlier ones:
+///
+///   AA, AKs, AKo, AK        a hand class (AK = suited and offsuit)
+///   TT+, ATs+, KJo+         pairs up to aces; kickers up to one below the top
+///   99-66, A5s-A2s          a span with a shared top card (pairs: any span)
+///   AsKs                    one explicit combo
+///   QQ:0.5, AKo:0.25        any entry may carry a finite, non-negative weight (default 1)
+///
+/// Returns false on malformed input and leaves `out` untouched.
+bool parseRange(std::string_view text, Range& out);
+
+/// Compact text form of a range: explicit combos with their weights, e.g.
+/// "AcAd,AcAh:0.5". Reparses to the same range.
+std::string toString(const Range& range);
+
+} // namespace poker
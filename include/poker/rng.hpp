@@ -0,0 +1,64 @@
+#pragma once
+
+#include "poker/deck.hpp"
+
+#include <cstdint>
+
+namespace poker {
+
+/// SplitMix64 step; used to expand seeds and derive independent streams.
+constexpr uint64_t splitMix64(uint64_t& state) {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+/// xoshiro256** generator: small state, a few cycles per draw and good enough
+/// statistics for simulation. Not thread-safe; give every thread its own.
+class Rng {
+public:
+    using result_type = uint64_t;
+
+    constexpr explicit Rng(uint64_t seed = 0) { reseed(seed); }
+
+    /// Generator for stream `stream` of `seed`. Streams derived this way are
+    /// independent for practical purposes, so per-thread or per-task
+    /// generators can be created without sharing state.
+    static constexpr Rng forStream(uint64_t seed, uint64_t stream) {
+        uint64_t s = seed ^ (stream * 0xd1342543de82ef95ull);
+        return Rng(splitMix64(s));
+    }
+
+    constexpr void reseed(uint64_t seed) {
+        for (uint64_t& word : s_) word = splitMix64(seed);
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return ~uint64_t{0}; }
+
+    constexpr uint64_t operator()() {
+        const uint64_t result = rotl(s_[1] * 5, 7) * 9;
+        const uint64_t t = s_[1] << 17;
+        s_[2] ^= s_[0];
+        s_[3] ^= s_[1];
+        s_[1] ^= s_[2];
+        s_[0] ^= s_[3];
+        s_[2] ^= t;
+        s_[3] = rotl(s_[3], 45);
+        return result;
+    }
+
+    /// Uniform integer in [0, bound).
+    constexpr uint32_t below(uint32_t bound) { return boundedRandom((*this)(), bound); }
+
+    /// Uniform double in [0, 1).
+    constexpr double uniform() { return static_cast<double>((*this)() >> 11) * 0x1.0p-53; }
+
+private:
+    static constexpr uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    uint64_t s_[4] = {};
+};
+
+} // namespace poker
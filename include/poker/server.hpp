@@ -0,0 +1,95 @@
+#pragma once
+
+#include "poker/table.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace poker {
+
+struct ServerConfig {
+    std::string address = "127.0.0.1";
+    uint16_t port = 0;            ///< 0 picks a free port; see GameServer::port()
+    unsigned threads = 1;         ///< event loops, each with its own tables
+    TableConfig table;
+    /// Every seat starts every hand with this stack, as in runSimulation().
+    Chips stack = 200;
+    uint64_t seed = 0x5e7e5eedu;
+    size_t bufferBytes = 4096;    ///< size of one pooled connection buffer
+    /// A client whose unsent output grows past this is disconnected.
+    size_t maxQueuedBytes = 256 * 1024;
+    /// A player who has not answered an ActionRequest after this long is
+    /// checked, or folded when facing a bet; 0 waits forever. Deadlines are
+    /// checked every 100 ms.
+    int actionTimeoutMs = 30'000;
+};
+
+/// Counters summed over all event loops.
+struct ServerStats {
+    uint64_t accepted = 0;
+    uint64_t disconnected = 0;
+    uint64_t hands = 0;
+    uint64_t actions = 0;          ///< actions applied for connected players
+    uint64_t illegalActions = 0;   ///< replaced by check or fold
+    uint64_t autoFolds = 0;        ///< for seats whose player left mid-hand
+    uint64_t timeouts = 0;         ///< actions taken for players who did not answer in time
+    uint64_t messagesIn = 0;
+    uint64_t messagesOut = 0;
+    uint64_t bytesIn = 0;
+    uint64_t bytesOut = 0;
+    uint64_t writeCalls = 0;       ///< sendmsg() calls; messagesOut / writeCalls is the batching factor
+    uint64_t tables = 0;           ///< tables created
+    uint64_t buffers = 0;          ///< pooled buffers allocated
+};
+
+/// Multi-table no-limit Hold'em server speaking the protocol in
+/// poker/protocol.hpp over TCP.
+///
+/// Each event loop thread owns an epoll instance, its own listening socket
+/// on the shared port (SO_REUSEPORT lets the kernel spread connections), its
+/// tables and a BufferPool; a connection and the table it sits at are only
+/// ever touched by one thread, so nothing is locked. A client sends Join and
+/// is seated at the first table of its loop with a free seat; a table deals
+/// whenever two or more players are seated and none is mid-hand. A player
+/// who does not answer an ActionRequest within `actionTimeoutMs` is acted
+/// for as if they had left, but keeps the seat. Replies
+/// are queued into pooled buffers while a batch of epoll events is handled,
+/// then written with one gathering sendmsg() per connection.
+class GameServer {
+public:
+    /// Binds the listening sockets. Throws std::runtime_error on failure and
+    /// std::invalid_argument for a bad configuration.
+    explicit GameServer(const ServerConfig& config);
+    /// Stops the server if it is running.
+    ~GameServer();
+
+    GameServer(const GameServer&) = delete;
+    GameServer& operator=(const GameServer&) = delete;
+
+    uint16_t port() const { return port_; }
+
+    /// Starts the event loop threads.
+    void start();
+    /// Wakes the loops, closes every connection and joins the threads.
+    void stop();
+
+    /// Valid once stop() has returned.
+    ServerStats stats() const;
+
+private:
+    class Loop;
+
+    ServerConfig config_;
+    uint16_t port_ = 0;
+    std::vector<std::unique_ptr<Loop>> loops_;
+    bool running_ = false;
+};
+
+/// Raises the soft open-file limit towards `wanted` (capped at the hard
+/// limit), since every connection costs a descriptor. Returns the new limit.
+size_t raiseOpenFileLimit(size_t wanted);
+
+} // namespace poker
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "poker/bot.hpp"
+#include "poker/table.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace poker {
+
+/// Builds the bot for one seat. Called once per seat per table on the thread
+/// that will run the table, so every thread owns its bot instances.
+using BotFactory = std::function<std::unique_ptr<Bot>(int seat)>;
+
+struct SimulationConfig {
+    int tables = 64;
+    uint64_t handsPerTable = 10000;
+    TableConfig table;
+    /// Every seat starts every hand with this stack (a cash game at constant
+    /// depth), so results do not depend on earlier hands.
+    Chips stack = 200;
+    unsigned threads = 0;         ///< 0 = hardware concurrency
+    bool pinThreads = false;      ///< bind shard t to CPU t where supported
+    uint64_t seed = 0x5e1f91a7u;
+    /// When set, shard t logs every hand to "<historyPath>.<t>" in the binary
+    /// hand-history format (see poker/hand_history.hpp), through its own
+    /// buffered writer. Table ids are the global table indices. A write error
+    /// is counted in `historyErrors` and ends that shard's logging, so its
+    /// file holds the hands before the failure.
+    std::string historyPath;
+};
+
+/// What one thread did.
+struct ShardStats {
+    int tables = 0;
+    uint64_t hands = 0;
+    uint64_t actions = 0;
+    uint64_t illegalActions = 0;  ///< bot choices replaced by check, or fold facing a bet
+    uint64_t historyErrors = 0;   ///< failed history appends and flushes
+    double seconds = 0;
+
+    double handsPerSecond() const { return seconds > 0 ? hands / seconds : 0; }
+};
+
+struct SimulationReport {
+    uint64_t hands = 0;
+    uint64_t actions = 0;
+    uint64_t illegalActions = 0;
+    uint64_t historyErrors = 0;         ///< nonzero means a history file is incomplete
+    double seconds = 0;                 ///< wall time of the whole run
+    std::vector<ShardStats> shards;     ///< one per thread
+    /// Net chips won by each seat, summed over all tables. Seats map to bots
+    /// through the factory, so this is the per-strategy result.
+    Chips net[kMaxSeats] = {};
+
+    double handsPerSecond() const { return seconds > 0 ? hands / seconds : 0; }
+    /// Mean of the shards' own rates; compare with handsPerSecond() / threads
+    /// to see how much is lost to scheduling or shared hardware.
+    double handsPerSecondPerCore() const;
+};
+
+/// Plays `config.handsPerTable` hands at each of `config.tables` independent
+/// tables, split into contiguous shards, one per thread.
+///
+/// Each thread builds its own tables (and so their arenas) and bots, and
+/// keeps its counters in locals that are published once when it finishes; the
+/// hot path touches no shared memory. Table i draws from
+/// `Rng::forStream(seed, i)`, so results are the same for any thread count.
+/// Throws std::invalid_argument for a bad configuration.
+SimulationReport runSimulation(const SimulationConfig& config, const BotFactory& makeBot);
+
+} // namespace poker
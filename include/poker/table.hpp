@@ -0,0 +1,205 @@
+#pragma once
+
+#include "poker/arena.hpp"
+#include "poker/card_set.hpp"
+#include "poker/deck.hpp"
+#include "poker/evaluator.hpp"
+#include "poker/variant.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace poker {
+
+class Rng;
+
+using Chips = int64_t;
+
+inline constexpr int kMaxSeats = 10;
+
+enum class Street : uint8_t { Preflop, Flop, Turn, River, Showdown };
+
+/// A player's decision. For Bet and Raise, `amount` is the player's total
+/// commitment on this street after the action ("raise to"); the two are
+/// interchangeable and the engine records whichever applies.
+struct Action {
+    enum Type : uint8_t { Fold, Check, Call, Bet, Raise };
+
+    Type type = Fold;
+    Chips amount = 0;
+
+    static constexpr Action fold() { return {Fold, 0}; }
+    static constexpr Action check() { return {Check, 0}; }
+    static constexpr Action call() { return {Call, 0}; }
+    static constexpr Action raiseTo(Chips total) { return {Raise, total}; }
+};
+
+/// Entries of a hand's event log: player actions plus what the dealer does.
+enum class EventType : uint8_t {
+    PostAnte,
+    PostSmallBlind,
+    PostBigBlind,
+    Fold,
+    Check,
+    Call,
+    Bet,
+    Raise,
+    DealFlop,
+    DealTurn,
+    DealRiver,
+    ReturnUncalled,
+    Show,
+    WinPot,
+};
+
+/// One log entry. `amount` is the chips moved by the event (for Bet and Raise,
+/// the street total reached). `seat` is -1 for dealer events; for WinPot,
+/// `pot` names the pot (0 = main).
+struct HandEvent {
+    Chips amount;
+    int8_t seat;
+    EventType type;
+    Street street;
+    uint8_t allIn;
+    uint8_t pot;
+};
+
+struct SeatState {
+    Chips stack = 0;          ///< chips behind, not committed this hand
+    Chips startingStack = 0;  ///< stack when the hand started
+    Chips streetCommitted = 0;
+    Chips handCommitted = 0;  ///< includes antes and earlier streets
+    Chips won = 0;            ///< chips collected at the end of the hand
+    CardSet hole;
+    HandValue showdownValue = 0;  ///< under the table's variant
+    bool occupied = false;
+    bool inHand = false;      ///< dealt into the current hand
+    bool folded = false;
+    bool allIn = false;
+};
+
+struct PotState {
+    Chips amount = 0;
+    uint16_t eligible = 0;    ///< seat bitmask of players who can win it
+};
+
+/// Everything about the hand in progress, in one fixed-size block.
+struct HandState {
+    uint64_t handNumber = 0;
+    SeatState seats[kMaxSeats];
+    PotState pots[kMaxSeats];
+    int potCount = 0;
+    CardSet board;
+    Street street = Street::Preflop;
+    int8_t button = -1;
+    int8_t smallBlindSeat = -1;
+    int8_t bigBlindSeat = -1;
+    int8_t toAct = -1;        ///< -1 when nobody is to act
+    Chips currentBet = 0;     ///< highest street commitment
+    Chips lastRaiseSize = 0;  ///< minimum raise increment
+    uint16_t pending = 0;     ///< seats that still have to act this street
+    uint16_t actedSinceFullRaise = 0;
+    bool complete = true;
+
+    int playersInHand() const;   ///< dealt and not folded
+    Chips totalPot() const;      ///< every chip committed this hand
+};
+
+/// What the player to act may do.
+struct LegalActions {
+    bool canCheck = false;
+    Chips toCall = 0;         ///< capped at the player's stack
+    bool canRaise = false;
+    Chips minRaiseTo = 0;     ///< smallest legal raise-to (all-in may be less)
+    Chips maxRaiseTo = 0;     ///< the player's all-in total
+
+    /// Whether Table::act() would accept `action`.
+    constexpr bool allows(const Action& action) const {
+        switch (action.type) {
+        case Action::Fold:
+            return true;
+        case Action::Check:
+            return canCheck;
+        case Action::Call:
+            return !canCheck;
+        default:
+            return canRaise && action.amount >= minRaiseTo && action.amount <= maxRaiseTo;
+        }
+    }
+};
+
+struct TableConfig {
+    int seats = 6;
+    Chips smallBlind = 1;
+    Chips bigBlind = 2;
+    Chips ante = 0;
+    /// Per-table arena for the event log; reset at the start of every hand.
+    size_t arenaBytes = 16 * 1024;
+};
+
+/// No-limit dealer for one table of a flop game (see poker/variant.hpp).
+///
+/// All per-hand state lives in a fixed-size HandState and the event log is
+/// kept in a per-table Arena that is reset when the next hand starts, so once
+/// the table is built, playing hands performs no heap allocation. The table is
+/// pinned in memory (the log points into its arena) and cannot be moved.
+///
+/// The variant decides the deck, the number of hole cards and how showdowns
+/// are evaluated, all at compile time; betting is the same for every variant.
+/// Instantiated for Holdem, ShortDeck and Omaha. The bots, simulator, hand
+/// histories and server play `Table`, the Hold'em instantiation.
+template <class Variant>
+class BasicTable {
+public:
+    explicit BasicTable(const TableConfig& config);
+
+    BasicTable(const BasicTable&) = delete;
+    BasicTable& operator=(const BasicTable&) = delete;
+
+    const TableConfig& config() const { return config_; }
+
+    /// Seats a player or changes their stack between hands. A seat with no
+    /// chips is skipped when dealing.
+    void seatPlayer(int seat, Chips stack);
+    void removePlayer(int seat);
+
+    /// Moves the button, posts antes and blinds and deals. Returns false when
+    /// fewer than two seated players have chips or a hand is still running.
+    bool startHand(Rng& rng);
+
+    bool handInProgress() const { return !state_.complete; }
+    int toAct() const { return state_.toAct; }
+    LegalActions legalActions() const;
+
+    /// Applies the action of the player to act. Returns false and leaves the
+    /// state untouched if the action is illegal.
+    bool act(const Action& action);
+
+    const HandState& state() const { return state_; }
+    const ArenaList<HandEvent>& events() const { return events_; }
+    const Arena& arena() const { return arena_; }
+
+private:
+    uint16_t seatsWhere(bool (*pred)(const SeatState&)) const;
+    int nextSeat(int from, uint16_t mask) const;
+    void log(EventType type, int seat, Chips amount, bool allIn = false, int pot = 0);
+    void commit(int seat, Chips amount);
+    void startStreet(Street street);
+    void afterAction(int seat);
+    void endStreet();
+    void finishHand();
+    void returnUncalled();
+    void buildPots();
+    void awardPots();
+
+    TableConfig config_;
+    HandState state_;
+    Arena arena_;
+    ArenaList<HandEvent> events_;
+    Deck deck_;
+    Card runout_[5];
+};
+
+using Table = BasicTable<Holdem>;
+
+} // namespace poker
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace poker {
+
+/// Fixed set of worker threads that run index-space jobs with work stealing.
+///
+/// A job is `count` tasks identified by index. Each worker starts on its own
+/// contiguous block of indices and takes tasks from the front of it; a worker
+/// whose block runs dry steals the back half of another worker's block. There
+/// is no shared queue and no per-task allocation, so fine-grained tasks stay
+/// cheap and uneven tasks still balance.
+class ThreadPool {
+public:
+    /// `threads` counts the calling thread, which always works as worker 0.
+    /// 0 means one worker per hardware thread.
+    explicit ThreadPool(unsigned threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const { return workerCount_; }
+
+    /// Runs `body(task, worker)` for every task in [0, count) and returns once
+    /// all of them have finished. `worker` is in [0, size()) and is stable for
+    /// the duration of one task, so it can index per-worker state. Jobs from
+    /// different callers are serialized; a task must not start a nested job.
+    template <class Body>
+    void parallelFor(size_t count, Body&& body) {
+        using Fn = std::remove_reference_t<Body>;
+        run(count,
+            [](void* ctx, size_t task, unsigned worker) { (*static_cast<Fn*>(ctx))(task, worker); },
+            const_cast<void*>(static_cast<const void*>(&body)));
+    }
+
+    /// Process-wide pool sized to the hardware.
+    static ThreadPool& shared();
+
+private:
+    using TaskFn = void (*)(void*, size_t, unsigned);
+
+    struct alignas(64) Block {
+        std::mutex lock;
+        size_t begin = 0;
+        size_t end = 0;
+    };
+
+    void run(size_t count, TaskFn fn, void* ctx);
+    void workerLoop(unsigned worker);
+    void work(unsigned worker);
+    bool take(unsigned worker, size_t& task);
+    bool steal(unsigned thief);
+
+    unsigned workerCount_ = 1;
+    std::unique_ptr<Block[]> blocks_;
+    std::vector<std::thread> threads_;
+
+    std::mutex runMutex_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    uint64_t generation_ = 0;
+    unsigned busy_ = 0;
+    bool stopping_ = false;
+    TaskFn fn_ = nullptr;
+    void* ctx_ = nullptr;
+};
+
+} // namespace poker
@@ -0,0 +1,163 @@
+#pragma once
+
+#include "poker/card_set.hpp"
+#include "poker/evaluator.hpp"
+
+#include <array>
+#include <cstdint>
+
+namespace poker {
+
+/// Game variants as compile-time policies.
+///
+/// The evaluator's showdown path, the equity engines and BasicTable are
+/// templates over one of these, so each variant is compiled into its own code
+/// path with its constants folded in; no hot loop asks which variant it is
+/// running. A policy names:
+///
+///   Ranking           hand-ranking rules, see poker/evaluator.hpp
+///   kHoleCards        cards dealt to each player
+///   kHoleCardsUsed    hole cards a hand must use, or 0 for the best five of
+///                     hole and board together
+///   kDeckBits         the cards in the deck
+struct Holdem {
+    using Ranking = StandardRanking;
+    static constexpr const char* kName = "holdem";
+    static constexpr int kHoleCards = 2;
+    static constexpr int kHoleCardsUsed = 0;
+    static constexpr uint64_t kDeckBits = kFullDeckBits;
+};
+
+/// Short-deck (six-plus) Hold'em on the 36 cards from six to ace.
+struct ShortDeck {
+    using Ranking = ShortDeckRanking;
+    static constexpr const char* kName = "shortdeck";
+    static constexpr int kHoleCards = 2;
+    static constexpr int kHoleCardsUsed = 0;
+    static constexpr uint64_t kDeckBits =
+        kFullDeckBits & ~(rankBits(kTwo) | rankBits(kThree) | rankBits(kFour) | rankBits(kFive));
+};
+
+/// Omaha: four hole cards, of which a hand uses exactly two with exactly
+/// three from the board.
+struct Omaha {
+    using Ranking = StandardRanking;
+    static constexpr const char* kName = "omaha";
+    static constexpr int kHoleCards = 4;
+    static constexpr int kHoleCardsUsed = 2;
+    static constexpr uint64_t kDeckBits = kFullDeckBits;
+};
+
+/// Number of cards in a variant's deck.
+template <class Variant>
+inline constexpr int kDeckSize = popcount(Variant::kDeckBits);
+
+/// A variant's deck in ascending card order, so a uniform index in
+/// [0, kDeckSize) draws a card without rejecting missing ranks.
+template <class Variant>
+inline constexpr std::array<Card, kDeckSize<Variant>> kDeckCards = [] {
+    std::array<Card, kDeckSize<Variant>> cards{};
+    size_t n = 0;
+    for (Card card : CardSet(Variant::kDeckBits)) cards[n++] = card;
+    return cards;
+}();
+
+namespace detail {
+
+/// Index pairs of the C(4, 2) two-card subsets of an Omaha hand.
+inline constexpr uint8_t kOmahaHolePairs[6][2] = {{0, 1}, {0, 2}, {1, 2}, {0, 3}, {1, 3}, {2, 3}};
+
+/// Index triples of the C(5, 3) three-card subsets of a board in colex order,
+/// so the first C(n, 3) of them only use the first n board cards.
+inline constexpr uint8_t kOmahaBoardTriples[10][3] = {
+    {0, 1, 2}, {0, 1, 3}, {0, 2, 3}, {1, 2, 3}, {0, 1, 4},
+    {0, 2, 4}, {1, 2, 4}, {0, 3, 4}, {1, 3, 4}, {2, 3, 4},
+};
+
+/// C(n, 3) for boards of n = 0..5 cards.
+inline constexpr int kOmahaTriplesForBoard[6] = {0, 0, 0, 1, 4, 10};
+
+/// Rank key of a single card, as summed by the evaluator.
+inline uint32_t cardRankKey(const EvalTables& t, Card card) {
+    return t.suitKey[1u << card.rank()];
+}
+
+} // namespace detail
+
+/// Evaluates an Omaha hand: the best of the 60 five-card hands made of two of
+/// the four hole cards and three of the 3..5 board cards. Returns 0 unless
+/// `hole` has four cards and `board` three to five.
+///
+/// Nothing is assembled per combination. The six hole-pair and ten board
+/// triple rank keys are summed once each, so a non-flush combination costs
+/// one addition and one rank-table lookup. Flushes are only possible in a suit
+/// with two hole and three board cards; only those suits enumerate their
+/// suited pairs and triples into the flush table.
+template <class Ranking = StandardRanking>
+inline HandValue evaluateOmaha(CardSet hole, CardSet board) {
+    if (hole.size() != 4 || board.size() < 3 || board.size() > 5) return 0;
+    const detail::EvalTables& t = detail::evalTables<Ranking>();
+    Card holeCards[4];
+    Card boardCards[5];
+    int boardCount = 0;
+    {
+        int n = 0;
+        for (Card card : hole) holeCards[n++] = card;
+        for (Card card : board) boardCards[boardCount++] = card;
+    }
+
+    uint32_t pairKeys[6];
+    for (int p = 0; p < 6; ++p) {
+        pairKeys[p] = detail::cardRankKey(t, holeCards[detail::kOmahaHolePairs[p][0]]) +
+                      detail::cardRankKey(t, holeCards[detail::kOmahaHolePairs[p][1]]);
+    }
+    const int triples = detail::kOmahaTriplesForBoard[boardCount];
+    HandValue best = 0;
+    for (int b = 0; b < triples; ++b) {
+        const uint8_t* triple = detail::kOmahaBoardTriples[b];
+        const uint32_t boardKey = detail::cardRankKey(t, boardCards[triple[0]]) +
+                                  detail::cardRankKey(t, boardCards[triple[1]]) +
+                                  detail::cardRankKey(t, boardCards[triple[2]]);
+        for (int p = 0; p < 6; ++p) {
+            const HandValue v = detail::lookupRankKey(t, pairKeys[p] + boardKey);
+            best = v > best ? v : best;
+        }
+    }
+
+    for (int suit = 0; suit < kNumSuits; ++suit) {
+        const uint16_t holeSuited = hole.suitMask(suit);
+        const uint16_t boardSuited = board.suitMask(suit);
+        if (__builtin_popcount(holeSuited) < 2 || __builtin_popcount(boardSuited) < 3) continue;
+        for (uint16_t a = holeSuited; a; a &= a - 1) {
+            for (uint16_t b = a & (a - 1); b; b &= b - 1) {
+                const uint16_t pair = (a & -a) | (b & -b);
+                for (uint16_t c = boardSuited; c; c &= c - 1) {
+                    for (uint16_t d = c & (c - 1); d; d &= d - 1) {
+                        for (uint16_t e = d & (d - 1); e; e &= e - 1) {
+                            const uint16_t mask = pair | (c & -c) | (d & -d) | (e & -e);
+                            const HandValue v = t.flushValue[mask];
+                            best = v > best ? v : best;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return best;
+}
+
+/// Showdown value of `hole` on `board` under a variant's rules. Values are
+/// only comparable within one variant.
+template <class Variant>
+inline HandValue showdownValue(CardSet hole, CardSet board) {
+    using Ranking = typename Variant::Ranking;
+    if constexpr (Variant::kHoleCardsUsed == 0) {
+        return evaluate<Ranking>(hole | board);
+    } else {
+        static_assert(Variant::kHoleCards == 4 && Variant::kHoleCardsUsed == 2,
+                      "only the Omaha two-plus-three rule is implemented");
+        return evaluateOmaha<Ranking>(hole, board);
+    }
+}
+
+} // namespace poker
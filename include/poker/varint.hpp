@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+
+namespace poker {
+namespace detail {
+
+/// LEB128: seven bits per byte, low group first, high bit set on all but the
+/// last byte. Writes at most 10 bytes and returns the end.
+inline uint8_t* putVarint(uint8_t* out, uint64_t value) {
+    while (value >= 0x80) {
+        *out++ = static_cast<uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = static_cast<uint8_t>(value);
+    return out;
+}
+
+/// Reads a varint written by putVarint() and advances `in`. Returns false if
+/// the input ends first or the value runs past 64 bits.
+inline bool getVarint(const uint8_t*& in, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && in < end; shift += 7) {
+        const uint8_t byte = *in++;
+        value |= uint64_t{byte & 0x7fu} << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+/// Maps signed values onto unsigned ones so small magnitudes stay short.
+constexpr uint64_t zigZag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+constexpr int64_t unZigZag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+} // namespace detail
+} // namespace poker
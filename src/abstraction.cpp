@@ -0,0 +1,468 @@
+#include "poker/abstraction.hpp"
+
+#include "poker/combinatorics.hpp"
+#include "poker/evaluator.hpp"
+#include "poker/isomorphism.hpp"
+#include "poker/kmeans.hpp"
+#include "poker/profile.hpp"
+#include "poker/range.hpp"
+#include "poker/rng.hpp"
+#include "poker/thread_pool.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace poker {
+
+namespace {
+
+// File layout: this header, then per built street a key table and a bucket
+// table of 1 << slotBits entries each, every section page-aligned. Empty
+// slots hold key 0.
+struct FileHeader {
+    struct StreetEntry {
+        uint64_t keysOffset;
+        uint64_t bucketsOffset;
+        uint64_t hands;
+        uint32_t slotBits;    ///< the table has 1 << slotBits slots
+        uint32_t buckets;     ///< 0 when the street was not built
+        uint64_t reserved[4];
+    };
+
+    char magic[8];
+    uint32_t version;
+    uint32_t streetCount;
+    uint64_t reserved[6];
+    StreetEntry streets[kNumStreets];
+};
+
+constexpr char kMagic[8] = {'P', 'K', 'B', 'U', 'C', 'K', 'E', 'T'};
+constexpr uint32_t kVersion = 1;
+constexpr uint64_t kKeyMarker = uint64_t{1} << 63;
+constexpr int kBoardSizes[kNumStreets] = {0, 3, 4, 5};
+constexpr int kMaxOpponents = 1081;     // C(47, 2): hands left after hole cards and a flop
+constexpr size_t kSectionAlign = 4096;  // sections start on page boundaries
+constexpr size_t kFeatureBlock = 1024;  // hands per feature/assignment task
+
+// Fibonacci hashing: the top bits of key * 2^64/phi.
+size_t slotOf(uint64_t key, uint32_t slotBits) {
+    return static_cast<size_t>((key * 0x9e3779b97f4a7c15ull) >> (64 - slotBits));
+}
+
+// Smallest table with a load factor of at most 0.7.
+uint32_t slotBitsFor(uint64_t hands) {
+    uint32_t bits = 3;
+    while ((uint64_t{1} << bits) * 7 < hands * 10) ++bits;
+    return bits;
+}
+
+size_t alignSection(size_t offset) { return (offset + kSectionAlign - 1) & ~(kSectionAlign - 1); }
+
+[[noreturn]] void fail(const char* who, const std::string& path, const char* what) {
+    throw std::runtime_error(std::string(who) + ": " + path + ": " + what);
+}
+
+// Every board of `size` cards that is its own canonical relabeling, in colex
+// order.
+std::vector<CardSet> canonicalBoards(int size) {
+    std::vector<CardSet> boards;
+    if (size == 0) {
+        boards.push_back(CardSet());
+        return boards;
+    }
+    int positions[kMaxSubsetSize];
+    for (int i = 0; i < size; ++i) positions[i] = i;
+    const uint64_t total = choose(kNumCards, size);
+    for (uint64_t index = 0; index < total; ++index, colexNext(positions, size)) {
+        CardSet board;
+        for (int i = 0; i < size; ++i) board.add(Card(static_cast<uint8_t>(positions[i])));
+        if (canonicalCards(board) == board) boards.push_back(board);
+    }
+    return boards;
+}
+
+// Appends the canonical hole cards on a canonical board: those not mapped to
+// a smaller set by any relabeling that leaves the board fixed. Returns how
+// many there are; `out` may be null to only count.
+size_t canonicalHoles(CardSet board, uint64_t* out) {
+    SuitPermutation fixing[kNumSuitPermutations];
+    int fixingCount = 0;
+    for (int p = 1; p < kNumSuitPermutations; ++p) {
+        if (suitPermutation(p).apply(board) == board) fixing[fixingCount++] = suitPermutation(p);
+    }
+    size_t count = 0;
+    for (int index = 0; index < kNumCombos; ++index) {
+        const CardSet hole = comboCards(index);
+        if (hole.intersects(board)) continue;
+        bool canonical = true;
+        for (int p = 0; p < fixingCount && canonical; ++p) {
+            canonical = fixing[p].apply(hole).bits() >= hole.bits();
+        }
+        if (!canonical) continue;
+        if (out) out[count] = board.bits() | uint64_t(index) << kNumCards | kKeyMarker;
+        ++count;
+    }
+    return count;
+}
+
+// Showdown equity of `hole` on a complete board against one random hand
+// drawn from the cards not in `used`: all of them when `samples` is 0 or
+// covers them, else `samples` random draws.
+double equityVsRandom(CardSet hole, CardSet board, CardSet used, int samples, Rng& rng,
+                      CardSet* hands, HandValue* values) {
+    const HandValue hero = evaluate(hole | board);
+    int count = 0;
+    const CardSet live = ~used;
+    if (samples == 0 || samples >= live.size() * (live.size() - 1) / 2) {
+        Card cards[kNumCards];
+        int n = 0;
+        for (Card c : live) cards[n++] = c;
+        for (int a = 1; a < n; ++a) {
+            for (int b = 0; b < a; ++b) hands[count++] = board | cards[a] | cards[b];
+        }
+    } else {
+        for (; count < samples; ++count) {
+            Card a, b;
+            do a = Card(static_cast<uint8_t>(rng.below(kNumCards))); while (used.contains(a));
+            do b = Card(static_cast<uint8_t>(rng.below(kNumCards))); while (used.contains(b) || a == b);
+            hands[count] = board | a | b;
+        }
+    }
+    evaluateBatch(hands, values, static_cast<size_t>(count));
+    int score = 0;  // two per win, one per tie
+    for (int i = 0; i < count; ++i) score += (hero > values[i]) * 2 + (hero == values[i]);
+    return score / (2.0 * count);
+}
+
+// Cumulative equity histogram of one hand over random board completions.
+// The generator is keyed by the hand, so a hand's feature does not depend
+// on which other hands are computed or in what order.
+void handFeature(uint64_t key, int street, const StreetAbstractionConfig& config, uint64_t seed,
+                 int stride, float* out) {
+    CardSet hole, board;
+    decodeHandKey(key, hole, board);
+    Rng rng = Rng::forStream(seed + static_cast<uint64_t>(street), key);
+    const int missing = 5 - board.size();
+    const int rollouts = missing > 0 ? config.rollouts : 1;
+    CardSet hands[kMaxOpponents];
+    HandValue values[kMaxOpponents];
+    std::fill_n(out, stride, 0.0f);
+    for (int r = 0; r < rollouts; ++r) {
+        CardSet full = board;
+        CardSet used = hole | board;
+        for (int m = 0; m < missing; ++m) {
+            Card c;
+            do c = Card(static_cast<uint8_t>(rng.below(kNumCards))); while (used.contains(c));
+            full.add(c);
+            used.add(c);
+        }
+        const double equity = equityVsRandom(hole, full, used, config.opponentSamples, rng, hands, values);
+        out[std::min(config.bins - 1, static_cast<int>(equity * config.bins))] += 1.0f;
+    }
+    float running = 0;
+    for (int b = 0; b < config.bins; ++b) {
+        running += out[b];
+        out[b] = running / rollouts;
+    }
+}
+
+void validate(const StreetAbstractionConfig& s) {
+    if (s.buckets < 1 || s.buckets > 65535) {
+        throw std::invalid_argument("buildAbstraction: buckets must be in [1, 65535]");
+    }
+    if (s.bins < 1 || s.bins > 256 || s.rollouts < 1 || s.opponentSamples < 0 ||
+        s.iterations < 1 || s.fitHands < 1) {
+        throw std::invalid_argument("buildAbstraction: bad street configuration");
+    }
+}
+
+struct StreetBuckets {
+    std::vector<uint64_t> keys;
+    std::vector<uint16_t> buckets;
+};
+
+StreetBuckets bucketStreet(int street, const StreetAbstractionConfig& config, uint64_t seed,
+                           ThreadPool& pool, StreetAbstractionReport& report) {
+    StreetBuckets result;
+    result.keys = canonicalHands(static_cast<Street>(street), &pool);
+    const size_t n = result.keys.size();
+    const int stride = kMeansStride(config.bins);
+    const size_t fitCount = std::min(n, config.fitHands);
+    auto fitHand = [&](size_t i) { return fitCount == n ? i : i * n / fitCount; };
+
+    std::vector<float> fitFeatures(fitCount * stride);
+    pool.parallelFor((fitCount + kFeatureBlock - 1) / kFeatureBlock, [&](size_t task, unsigned) {
+        const size_t end = std::min(fitCount, (task + 1) * kFeatureBlock);
+        POKER_PROFILE_SCOPE(AbstractionFeatures);
+        for (size_t i = task * kFeatureBlock; i < end; ++i) {
+            handFeature(result.keys[fitHand(i)], street, config, seed, stride, &fitFeatures[i * stride]);
+        }
+    });
+
+    // With no more hands than buckets every fitted hand is its own centroid.
+    const bool lossless = static_cast<size_t>(config.buckets) >= fitCount;
+    std::vector<float> centroids;
+    int k = 0;
+    if (lossless) {
+        k = static_cast<int>(fitCount);
+        centroids = fitFeatures;
+    } else {
+        KMeansOptions options;
+        options.clusters = config.buckets;
+        options.maxIterations = config.iterations;
+        options.seed = seed + static_cast<uint64_t>(street);
+        options.pool = &pool;
+        KMeansResult fit = kMeans(fitFeatures.data(), fitCount, stride, options);
+        k = config.buckets;
+        centroids = std::move(fit.centroids);
+        report.iterations = fit.iterations;
+        report.inertia = fit.inertia;
+    }
+
+    // Number buckets by ascending mean equity, i.e. descending CDF mass.
+    std::vector<double> mass(k, 0.0);
+    for (int c = 0; c < k; ++c) {
+        for (int b = 0; b < config.bins; ++b) mass[c] += centroids[size_t(c) * stride + b];
+    }
+    std::vector<int> order(k);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return mass[a] > mass[b]; });
+    std::vector<uint16_t> label(k);
+    for (int i = 0; i < k; ++i) label[order[i]] = static_cast<uint16_t>(i);
+
+    result.buckets.resize(n);
+    std::vector<std::vector<float>> scratch(pool.size(), std::vector<float>(kFeatureBlock * stride));
+    pool.parallelFor((n + kFeatureBlock - 1) / kFeatureBlock, [&](size_t task, unsigned worker) {
+        const size_t first = task * kFeatureBlock;
+        const size_t count = std::min(kFeatureBlock, n - first);
+        if (lossless && fitCount == n) {
+            for (size_t i = 0; i < count; ++i) result.buckets[first + i] = label[first + i];
+            return;
+        }
+        const float* features = fitCount == n ? &fitFeatures[first * stride] : scratch[worker].data();
+        if (fitCount != n) {
+            POKER_PROFILE_SCOPE(AbstractionFeatures);
+            for (size_t i = 0; i < count; ++i) {
+                handFeature(result.keys[first + i], street, config, seed, stride,
+                            scratch[worker].data() + i * stride);
+            }
+        }
+        uint32_t nearest[kFeatureBlock];
+        float distance[kFeatureBlock];
+        nearestCentroids(features, count, centroids.data(), k, stride, nearest, distance);
+        for (size_t i = 0; i < count; ++i) result.buckets[first + i] = label[nearest[i]];
+    });
+
+    report.hands = n;
+    report.buckets = k;
+    return result;
+}
+
+} // namespace
+
+uint64_t canonicalHandKey(CardSet hole, CardSet board) {
+    uint64_t bestBoard = ~uint64_t{0};
+    uint64_t bestHole = ~uint64_t{0};
+    for (int p = 0; p < kNumSuitPermutations; ++p) {
+        const SuitPermutation& perm = suitPermutation(p);
+        const uint64_t b = perm.apply(board).bits();
+        if (b > bestBoard) continue;
+        const uint64_t h = perm.apply(hole).bits();
+        if (b < bestBoard || h < bestHole) {
+            bestBoard = b;
+            bestHole = h;
+        }
+    }
+    const CardSet canonical(bestHole);
+    const int index = comboIndex(canonical.lowest(), Card(static_cast<uint8_t>(63 - __builtin_clzll(bestHole))));
+    return bestBoard | uint64_t(index) << kNumCards | kKeyMarker;
+}
+
+void decodeHandKey(uint64_t key, CardSet& hole, CardSet& board) {
+    board = CardSet(key & kFullDeckBits);
+    hole = comboCards(static_cast<int>((key & ~kKeyMarker) >> kNumCards));
+}
+
+std::vector<uint64_t> canonicalHands(Street street, ThreadPool* pool) {
+    const int index = static_cast<int>(street);
+    if (index < 0 || index >= kNumStreets) throw std::invalid_argument("canonicalHands: no such street");
+    ThreadPool& workers = pool ? *pool : ThreadPool::shared();
+    const std::vector<CardSet> boards = canonicalBoards(kBoardSizes[index]);
+
+    // Count per board, then fill at the prefix offsets, so the order is
+    // fixed without a sort or per-board vectors.
+    std::vector<size_t> offsets(boards.size() + 1, 0);
+    workers.parallelFor(boards.size(), [&](size_t b, unsigned) {
+        offsets[b + 1] = canonicalHoles(boards[b], nullptr);
+    });
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    std::vector<uint64_t> keys(offsets.back());
+    workers.parallelFor(boards.size(), [&](size_t b, unsigned) {
+        canonicalHoles(boards[b], keys.data() + offsets[b]);
+    });
+    return keys;
+}
+
+AbstractionReport buildAbstraction(const AbstractionConfig& config, const std::string& path) {
+    static_assert(sizeof(FileHeader) == 64 + 64 * kNumStreets, "bucket map header layout");
+    for (const StreetAbstractionConfig& s : config.streets) {
+        if (s.enabled) validate(s);
+    }
+    ThreadPool& pool = config.pool ? *config.pool : ThreadPool::shared();
+    const char* who = "buildAbstraction";
+
+    const std::string temp = path + ".tmp";
+    const int fd = ::open(temp.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) fail(who, temp, std::strerror(errno));
+
+    AbstractionReport report;
+    FileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof kMagic);
+    header.version = kVersion;
+    header.streetCount = kNumStreets;
+    size_t fileBytes = alignSection(sizeof header);
+    try {
+        for (int street = 0; street < kNumStreets; ++street) {
+            const StreetAbstractionConfig& streetConfig = config.streets[street];
+            if (!streetConfig.enabled) continue;
+            const auto start = std::chrono::steady_clock::now();
+            StreetAbstractionReport& streetReport = report.streets[street];
+            StreetBuckets built = bucketStreet(street, streetConfig, config.seed, pool, streetReport);
+
+            // Append this street's table to the file before building the
+            // next, so only one street is ever held in memory.
+            FileHeader::StreetEntry& entry = header.streets[street];
+            entry.hands = built.keys.size();
+            entry.buckets = static_cast<uint32_t>(streetReport.buckets);
+            entry.slotBits = slotBitsFor(entry.hands);
+            const size_t slots = size_t{1} << entry.slotBits;
+            entry.keysOffset = fileBytes;
+            entry.bucketsOffset = alignSection(entry.keysOffset + slots * sizeof(uint64_t));
+            const size_t end = alignSection(entry.bucketsOffset + slots * sizeof(uint16_t));
+            if (::ftruncate(fd, static_cast<off_t>(end)) != 0) fail(who, temp, std::strerror(errno));
+            void* region = ::mmap(nullptr, end - fileBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+                                  static_cast<off_t>(fileBytes));
+            if (region == MAP_FAILED) fail(who, temp, std::strerror(errno));
+            uint64_t* keys = static_cast<uint64_t*>(region);
+            uint16_t* buckets = reinterpret_cast<uint16_t*>(static_cast<char*>(region) +
+                                                            (entry.bucketsOffset - fileBytes));
+            const size_t mask = slots - 1;
+            for (size_t i = 0; i < built.keys.size(); ++i) {
+                size_t slot = slotOf(built.keys[i], entry.slotBits);
+                while (keys[slot] != 0) slot = (slot + 1) & mask;
+                keys[slot] = built.keys[i];
+                buckets[slot] = built.buckets[i];
+            }
+            ::munmap(region, end - fileBytes);
+            fileBytes = end;
+            streetReport.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        if (fileBytes == alignSection(sizeof header) &&
+            ::ftruncate(fd, static_cast<off_t>(fileBytes)) != 0) {
+            fail(who, temp, std::strerror(errno));
+        }
+        if (::pwrite(fd, &header, sizeof header, 0) != static_cast<ssize_t>(sizeof header) ||
+            ::fsync(fd) != 0) {
+            fail(who, temp, std::strerror(errno));
+        }
+    } catch (...) {
+        ::close(fd);
+        ::unlink(temp.c_str());
+        throw;
+    }
+    if (::close(fd) != 0 || ::rename(temp.c_str(), path.c_str()) != 0) {
+        const int error = errno;
+        ::unlink(temp.c_str());
+        fail(who, path, std::strerror(error));
+    }
+    report.fileBytes = fileBytes;
+    return report;
+}
+
+BucketMap::BucketMap(const std::string& path) {
+    const char* who = "BucketMap";
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) fail(who, path, std::strerror(errno));
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(FileHeader)) {
+        ::close(fd);
+        fail(who, path, "not a bucket map");
+    }
+    bytes_ = static_cast<size_t>(st.st_size);
+    void* p = ::mmap(nullptr, bytes_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) fail(who, path, std::strerror(errno));
+    base_ = p;
+
+    const FileHeader& header = *static_cast<const FileHeader*>(base_);
+    bool valid = std::memcmp(header.magic, kMagic, sizeof kMagic) == 0 &&
+                 header.version == kVersion && header.streetCount == kNumStreets;
+    for (int s = 0; valid && s < kNumStreets; ++s) {
+        const FileHeader::StreetEntry& entry = header.streets[s];
+        if (entry.buckets == 0) continue;
+        const uint64_t slots = uint64_t{1} << (entry.slotBits & 63);
+        valid = entry.slotBits >= 3 && entry.slotBits < 40 && entry.hands < slots &&
+                entry.keysOffset % kSectionAlign == 0 && entry.bucketsOffset % kSectionAlign == 0 &&
+                entry.keysOffset + slots * sizeof(uint64_t) <= bytes_ &&
+                entry.bucketsOffset + slots * sizeof(uint16_t) <= bytes_;
+        if (!valid) break;
+        StreetTable& table = streets_[s];
+        table.keys = reinterpret_cast<const uint64_t*>(static_cast<const char*>(base_) + entry.keysOffset);
+        table.buckets = reinterpret_cast<const uint16_t*>(static_cast<const char*>(base_) + entry.bucketsOffset);
+        table.slotBits = entry.slotBits;
+        table.hands = entry.hands;
+        table.bucketCount = static_cast<int>(entry.buckets);
+    }
+    if (!valid) {
+        ::munmap(base_, bytes_);
+        fail(who, path, "not a bucket map");
+    }
+    // Lookups land anywhere in the tables; skip readahead.
+    ::madvise(base_, bytes_, MADV_RANDOM);
+}
+
+BucketMap::~BucketMap() {
+    if (base_) ::munmap(base_, bytes_);
+}
+
+int BucketMap::bucket(CardSet hole, CardSet board) const {
+    const int boardSize = board.size();
+    const int street = boardSize == 0 ? 0 : boardSize - 2;
+    if (hole.size() != 2 || hole.intersects(board) || street < 0 || street >= kNumStreets ||
+        kBoardSizes[street] != boardSize) {
+        return -1;
+    }
+    const StreetTable& table = streets_[street];
+    if (!table.keys) return -1;
+    const uint64_t key = canonicalHandKey(hole, board);
+    // A well-formed table always has an empty slot, but a corrupt file may
+    // not; never probe more than the whole table.
+    const size_t slots = size_t{1} << table.slotBits;
+    size_t slot = slotOf(key, table.slotBits);
+    for (size_t probe = 0; probe < slots; ++probe, slot = (slot + 1) & (slots - 1)) {
+        if (table.keys[slot] == key) return table.buckets[slot];
+        if (table.keys[slot] == 0) return -1;
+    }
+    return -1;
+}
+
+int BucketMap::buckets(Street street) const {
+    const int s = static_cast<int>(street);
+    return s < kNumStreets ? streets_[s].bucketCount : 0;
+}
+
+size_t BucketMap::hands(Street street) const {
+    const int s = static_cast<int>(street);
+    return s < kNumStreets ? streets_[s].hands : 0;
+}
+
+} // namespace poker
@@ -0,0 +1,276 @@
+#include "poker/analytics.hpp"
+
+#include "poker/thread_pool.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+namespace poker {
+
+namespace {
+
+// Records per parallel task: large enough to amortize scheduling, small
+// enough to balance across workers.
+constexpr size_t kRecordsPerChunk = 4096;
+
+constexpr char kCheckpointMagic[4] = {'P', 'K', 'S', 'T'};
+constexpr uint32_t kCheckpointVersion = 2;
+
+// A worker's private totals on their own cache lines.
+struct alignas(64) WorkerStats {
+    HandStats stats;
+};
+
+bool writeValue(FILE* f, const void* p, size_t n) { return std::fwrite(p, 1, n, f) == n; }
+bool readValue(FILE* f, void* p, size_t n) { return std::fread(p, 1, n, f) == n; }
+
+} // namespace
+
+PlayerStats& PlayerStats::operator+=(const PlayerStats& o) {
+    hands += o.hands;
+    vpip += o.vpip;
+    pfr += o.pfr;
+    bets += o.bets;
+    calls += o.calls;
+    folds += o.folds;
+    showdowns += o.showdowns;
+    showdownWins += o.showdownWins;
+    net += o.net;
+    return *this;
+}
+
+PlayerId tableSeatKey(const HandHeader& header, int seat) {
+    return PlayerId{header.tableId} * kMaxSeats + static_cast<PlayerId>(seat);
+}
+
+PlayerId seatKey(const HandHeader&, int seat) { return static_cast<PlayerId>(seat); }
+
+PlayerStats HandStats::player(PlayerId id) const {
+    const auto it = players_.find(id);
+    return it != players_.end() ? it->second : PlayerStats();
+}
+
+std::vector<std::pair<PlayerId, PlayerStats>> HandStats::players() const {
+    std::vector<std::pair<PlayerId, PlayerStats>> sorted(players_.begin(), players_.end());
+    std::sort(sorted.begin(), sorted.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+    return sorted;
+}
+
+void HandStats::add(const HandView& hand, PlayerKeyFn key) {
+    const HandHeader& h = hand.header;
+    Chips streetCommitted[kMaxSeats] = {};
+    Chips net[kMaxSeats] = {};
+    bool vpip[kMaxSeats] = {};
+    bool pfr[kMaxSeats] = {};
+    bool showed[kMaxSeats] = {};
+    bool wonShowdown[kMaxSeats] = {};
+    uint32_t bets[kMaxSeats] = {};
+    uint32_t calls[kMaxSeats] = {};
+    uint32_t folds[kMaxSeats] = {};
+
+    EventReader events = hand.events();
+    HandEvent e;
+    while (events.next(e)) {
+        const int s = e.seat;
+        const bool dealerEvent = e.type == EventType::DealFlop || e.type == EventType::DealTurn ||
+                                 e.type == EventType::DealRiver;
+        // Only a corrupt record names a seat outside the hand.
+        if (!dealerEvent && (s < 0 || s >= kMaxSeats || !(h.dealt & (1u << s)))) continue;
+        const bool preflop = e.street == Street::Preflop;
+        switch (e.type) {
+        case EventType::PostAnte:
+            net[s] -= e.amount;
+            break;
+        case EventType::PostSmallBlind:
+        case EventType::PostBigBlind:
+            streetCommitted[s] += e.amount;
+            net[s] -= e.amount;
+            break;
+        case EventType::Call:
+            streetCommitted[s] += e.amount;
+            net[s] -= e.amount;
+            if (preflop) vpip[s] = true;
+            else ++calls[s];
+            break;
+        case EventType::Bet:
+        case EventType::Raise:
+            net[s] -= e.amount - streetCommitted[s];
+            streetCommitted[s] = e.amount;
+            if (preflop) vpip[s] = pfr[s] = true;
+            else ++bets[s];
+            break;
+        case EventType::Fold:
+            ++folds[s];
+            break;
+        case EventType::DealFlop:
+        case EventType::DealTurn:
+        case EventType::DealRiver:
+            std::memset(streetCommitted, 0, sizeof streetCommitted);
+            break;
+        case EventType::ReturnUncalled:
+            net[s] += e.amount;
+            break;
+        case EventType::Show:
+            showed[s] = true;
+            break;
+        case EventType::WinPot:
+            net[s] += e.amount;
+            if (showed[s]) wonShowdown[s] = true;
+            break;
+        default:
+            break;
+        }
+    }
+
+    ++hands_;
+    for (int s = 0; s < kMaxSeats; ++s) {
+        if (!(h.dealt & (1u << s))) continue;
+        PlayerStats& p = at(key(h, s));
+        ++p.hands;
+        p.vpip += vpip[s];
+        p.pfr += pfr[s];
+        p.bets += bets[s];
+        p.calls += calls[s];
+        p.folds += folds[s];
+        p.showdowns += showed[s];
+        p.showdownWins += wonShowdown[s];
+        p.net += net[s];
+    }
+}
+
+void HandStats::merge(const HandStats& other) {
+    for (const auto& [id, stats] : other.players_) players_[id] += stats;
+    hands_ += other.hands_;
+}
+
+StatsPipeline::StatsPipeline(PlayerKeyFn key, ThreadPool* pool)
+    : key_(key ? key : tableSeatKey), pool_(pool) {}
+
+uint64_t StatsPipeline::offset(const std::string& path) const {
+    for (const auto& entry : offsets_) {
+        if (entry.first == path) return entry.second;
+    }
+    return 0;
+}
+
+uint64_t StatsPipeline::update(const std::string& path) {
+    HandHistoryReader reader(path);
+    const uint8_t* const file = reader.data();
+    const size_t size = reader.size();
+
+    size_t start = static_cast<size_t>(offset(path));
+    if (start == 0) start = hand_history::kFileHeaderBytes;
+    if (start > size) throw std::runtime_error("StatsPipeline: " + path + " shrank");
+
+    // Chunk boundaries from the length prefixes alone; stops before a
+    // record that is not completely written yet.
+    std::vector<size_t> bounds{start};
+    size_t at = start;
+    size_t records = 0;
+    while (at < size) {
+        const size_t next = hand_history::recordEnd(file, size, at);
+        if (next == 0) break;
+        at = next;
+        if (++records % kRecordsPerChunk == 0) bounds.push_back(at);
+    }
+    if (bounds.back() != at) bounds.push_back(at);
+    if (records == 0) return 0;
+
+    ThreadPool& pool = pool_ ? *pool_ : ThreadPool::shared();
+    std::vector<std::unique_ptr<WorkerStats>> workers(pool.size());
+    for (auto& w : workers) w = std::make_unique<WorkerStats>();
+    std::vector<uint8_t> chunkCorrupt(bounds.size() - 1);
+    pool.parallelFor(bounds.size() - 1, [&](size_t chunk, unsigned worker) {
+        HandStats& local = workers[worker]->stats;
+        HandView hand;
+        for (size_t record = bounds[chunk]; record < bounds[chunk + 1];) {
+            record = decodeRecord(file, size, record, hand);
+            if (record == 0) {
+                chunkCorrupt[chunk] = 1;
+                return;
+            }
+            local.add(hand, key_);
+        }
+    });
+    for (uint8_t bad : chunkCorrupt) {
+        if (bad) throw std::runtime_error("StatsPipeline: " + path + " has a malformed record");
+    }
+
+    for (const auto& w : workers) stats_.merge(w->stats);
+    bool known = false;
+    for (auto& entry : offsets_) {
+        if (entry.first == path) {
+            entry.second = at;
+            known = true;
+        }
+    }
+    if (!known) offsets_.emplace_back(path, at);
+    return records;
+}
+
+bool StatsPipeline::save(const std::string& path) const {
+    const std::string temp = path + ".tmp";
+    FILE* f = std::fopen(temp.c_str(), "wb");
+    if (!f) return false;
+    const uint64_t files = offsets_.size();
+    const uint64_t players = stats_.players_.size();
+    bool ok = writeValue(f, kCheckpointMagic, sizeof kCheckpointMagic) &&
+              writeValue(f, &kCheckpointVersion, sizeof kCheckpointVersion) &&
+              writeValue(f, &stats_.hands_, sizeof stats_.hands_) &&
+              writeValue(f, &files, sizeof files);
+    for (const auto& [name, consumed] : offsets_) {
+        const uint64_t length = name.size();
+        ok = ok && writeValue(f, &length, sizeof length) && writeValue(f, name.data(), length) &&
+             writeValue(f, &consumed, sizeof consumed);
+    }
+    ok = ok && writeValue(f, &players, sizeof players);
+    for (const auto& [id, stats] : stats_.players()) {
+        ok = ok && writeValue(f, &id, sizeof id) && writeValue(f, &stats, sizeof stats);
+    }
+    ok = std::fclose(f) == 0 && ok;
+    if (ok && std::rename(temp.c_str(), path.c_str()) == 0) return true;
+    std::remove(temp.c_str());
+    return false;
+}
+
+bool StatsPipeline::load(const std::string& path) {
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+    char magic[4];
+    uint32_t version = 0;
+    HandStats stats;
+    uint64_t files = 0;
+    uint64_t players = 0;
+    std::vector<std::pair<std::string, uint64_t>> offsets;
+    bool ok = readValue(f, magic, sizeof magic) &&
+              std::memcmp(magic, kCheckpointMagic, sizeof magic) == 0 &&
+              readValue(f, &version, sizeof version) && version == kCheckpointVersion &&
+              readValue(f, &stats.hands_, sizeof stats.hands_) && readValue(f, &files, sizeof files) &&
+              files < (1u << 20);
+    for (uint64_t i = 0; ok && i < files; ++i) {
+        uint64_t length = 0;
+        ok = readValue(f, &length, sizeof length) && length < 4096;
+        std::string name(ok ? length : 0, '\0');
+        uint64_t consumed = 0;
+        ok = ok && readValue(f, name.data(), length) && readValue(f, &consumed, sizeof consumed);
+        if (ok) offsets.emplace_back(std::move(name), consumed);
+    }
+    ok = ok && readValue(f, &players, sizeof players) && players < (uint64_t{1} << 32);
+    for (uint64_t i = 0; ok && i < players; ++i) {
+        PlayerId id = 0;
+        PlayerStats player;
+        ok = readValue(f, &id, sizeof id) && readValue(f, &player, sizeof player) &&
+             stats.players_.emplace(id, player).second;
+    }
+    std::fclose(f);
+    if (!ok) return false;
+    stats_ = std::move(stats);
+    offsets_ = std::move(offsets);
+    return true;
+}
+
+} // namespace poker
@@ -0,0 +1,133 @@
+#include "poker/bot.hpp"
+
+#include "poker/abstraction.hpp"
+#include "poker/evaluator.hpp"
+#include "poker/rng.hpp"
+
+#include <algorithm>
+
+namespace poker {
+
+namespace {
+
+Action passive(const LegalActions& legal) {
+    return legal.canCheck ? Action::check() : Action::call();
+}
+
+Action raiseBy(const LegalActions& legal, Chips target) {
+    if (!legal.canRaise) return passive(legal);
+    return Action::raiseTo(std::clamp(target, legal.minRaiseTo, legal.maxRaiseTo));
+}
+
+class RandomBot final : public Bot {
+public:
+    Action act(const Table&, int, const LegalActions& legal, Rng& rng) override {
+        switch (rng.below(3)) {
+        case 0:
+            return legal.canCheck ? Action::check() : Action::fold();
+        case 1:
+            return passive(legal);
+        default: {
+            const Chips span = legal.maxRaiseTo - legal.minRaiseTo;
+            const Chips extra = span > 0 ? rng.below(static_cast<uint32_t>(span) + 1) : 0;
+            return raiseBy(legal, legal.minRaiseTo + extra);
+        }
+        }
+    }
+    const char* name() const override { return "random"; }
+};
+
+class CallingStationBot final : public Bot {
+public:
+    Action act(const Table&, int, const LegalActions& legal, Rng&) override { return passive(legal); }
+    const char* name() const override { return "calling-station"; }
+};
+
+// Preflop strength on a 0..20 scale, after Bill Chen's formula.
+int preflopScore(CardSet hole) {
+    const Card a = hole.lowest();
+    const Card b = (hole - CardSet(a)).lowest();
+    const int high = std::max(a.rank(), b.rank());
+    const int low = std::min(a.rank(), b.rank());
+    static constexpr int kHighCardPoints[kNumRanks] = {1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 7, 8, 10};
+    int score = kHighCardPoints[high];
+    if (high == low) return std::max(5, 2 * score);
+    if (a.suit() == b.suit()) score += 2;
+    const int gap = high - low - 1;
+    score -= gap == 0 ? 0 : gap == 1 ? 1 : gap == 2 ? 2 : gap == 3 ? 4 : 5;
+    if (gap <= 1 && high < kQueen) score += 1;
+    return score;
+}
+
+class TightAggressiveBot final : public Bot {
+public:
+    Action act(const Table& table, int seat, const LegalActions& legal, Rng& rng) override {
+        const HandState& st = table.state();
+        const CardSet hole = st.seats[seat].hole;
+        const Chips pot = st.totalPot();
+        if (st.street == Street::Preflop) {
+            const int score = preflopScore(hole);
+            if (score >= 10) return raiseBy(legal, st.currentBet * 3);
+            if (score >= 7 && legal.toCall <= table.config().bigBlind * 3) return passive(legal);
+            return legal.canCheck ? Action::check() : Action::fold();
+        }
+        // Postflop: bet what the hole cards add to the board, call small bets
+        // with a pair, give up otherwise.
+        const HandValue value = evaluate(hole | st.board);
+        const HandCategory made = handCategory(value);
+        const bool playsBoard = st.board.size() == 5 && value == evaluate(st.board);
+        if (made >= HandCategory::TwoPair && !playsBoard) {
+            return raiseBy(legal, st.currentBet + pot * 2 / 3);
+        }
+        if (made >= HandCategory::OnePair && legal.toCall * 3 <= pot) {
+            if (legal.canCheck && rng.below(4) == 0) return raiseBy(legal, pot / 2);
+            return passive(legal);
+        }
+        return legal.canCheck ? Action::check() : Action::fold();
+    }
+    const char* name() const override { return "tight-aggressive"; }
+};
+
+class BucketBot final : public Bot {
+public:
+    explicit BucketBot(const BucketMap& map) : map_(map) {}
+
+    Action act(const Table& table, int seat, const LegalActions& legal, Rng& rng) override {
+        const HandState& st = table.state();
+        const int buckets = map_.buckets(st.street);
+        const int bucket = buckets > 0 ? map_.bucket(st.seats[seat].hole, st.board) : -1;
+        if (bucket < 0) return fallback_.act(table, seat, legal, rng);
+
+        // Same prices as the chart bot, with the bucket standing in for its
+        // hand score.
+        const double strength = (bucket + 0.5) / buckets;
+        const Chips pot = st.totalPot();
+        if (st.street == Street::Preflop) {
+            if (strength >= kRaise) return raiseBy(legal, st.currentBet * 3);
+            if (strength >= kCall && legal.toCall <= table.config().bigBlind * 3) return passive(legal);
+        } else {
+            if (strength >= kRaise) return raiseBy(legal, st.currentBet + pot * 2 / 3);
+            if (strength >= kCall && legal.toCall * 3 <= pot) return passive(legal);
+        }
+        return legal.canCheck ? Action::check() : Action::fold();
+    }
+    const char* name() const override { return "bucket"; }
+
+private:
+    // Bucket percentiles; buckets are unweighted by combos, so these sit
+    // higher than the share of hands they let through.
+    static constexpr double kRaise = 0.93;
+    static constexpr double kCall = 0.75;
+
+    const BucketMap& map_;
+    TightAggressiveBot fallback_;
+};
+
+} // namespace
+
+std::unique_ptr<Bot> makeRandomBot() { return std::make_unique<RandomBot>(); }
+std::unique_ptr<Bot> makeCallingStationBot() { return std::make_unique<CallingStationBot>(); }
+std::unique_ptr<Bot> makeTightAggressiveBot() { return std::make_unique<TightAggressiveBot>(); }
+std::unique_ptr<Bot> makeBucketBot(const BucketMap& map) { return std::make_unique<BucketBot>(map); }
+
+} // namespace poker
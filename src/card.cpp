@@ -0,0 +1,72 @@
+#include "poker/card.hpp"
+
+namespace poker {
+
+namespace {
+
+constexpr char kRankChars[] = "23456789TJQKA";
+constexpr char kSuitChars[] = "cdhs";
+
+} // namespace
+
+char rankChar(int rank) {
+    return (rank >= 0 && rank < kNumRanks) ? kRankChars[rank] : '?';
+}
+
+char suitChar(int suit) {
+    return (suit >= 0 && suit < kNumSuits) ? kSuitChars[suit] : '?';
+}
+
+int parseRank(char c) {
+    switch (c) {
+    case 't': return kTen;
+    case 'j': return kJack;
+    case 'q': return kQueen;
+    case 'k': return kKing;
+    case 'a': return kAce;
+    default: break;
+    }
+    for (int r = 0; r < kNumRanks; ++r) {
+        if (kRankChars[r] == c) return r;
+    }
+    return -1;
+}
+
+int parseSuit(char c) {
+    if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+    for (int s = 0; s < kNumSuits; ++s) {
+        if (kSuitChars[s] == c) return s;
+    }
+    return -1;
+}
+
+std::string toString(Card card) {
+    return {rankChar(card.rank()), suitChar(card.suit())};
+}
+
+bool parseCard(std::string_view text, Card& out) {
+    if (text.size() != 2) return false;
+    const int rank = parseRank(text[0]);
+    const int suit = parseSuit(text[1]);
+    if (rank < 0 || suit < 0) return false;
+    out = Card(rank, suit);
+    return true;
+}
+
+int parseCards(std::string_view text, Card* out, int capacity) {
+    int count = 0;
+    size_t i = 0;
+    while (i < text.size()) {
+        if (text[i] == ' ' || text[i] == '\t' || text[i] == ',') {
+            ++i;
+            continue;
+        }
+        if (i + 1 >= text.size() || count >= capacity) return -1;
+        if (!parseCard(text.substr(i, 2), out[count])) return -1;
+        ++count;
+        i += 2;
+    }
+    return count;
+}
+
+} // namespace poker
@@ -0,0 +1,25 @@
+#include "poker/card_set.hpp"
+
+namespace poker {
+
+std::string toString(CardSet cards) {
+    std::string text;
+    text.reserve(2 * cards.size());
+    for (Card card : cards) text += toString(card);
+    return text;
+}
+
+bool parseCardSet(std::string_view text, CardSet& out) {
+    Card cards[kNumCards];
+    const int count = parseCards(text, cards, kNumCards);
+    if (count < 0) return false;
+    CardSet set;
+    for (int i = 0; i < count; ++i) {
+        if (set.contains(cards[i])) return false;
+        set.add(cards[i]);
+    }
+    out = set;
+    return true;
+}
+
+} // namespace poker
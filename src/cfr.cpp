@@ -0,0 +1,492 @@
+#include "poker/cfr.hpp"
+
+#include "poker/abstraction.hpp"
+#include "poker/arena.hpp"
+#include "poker/evaluator.hpp"
+#include "poker/profile.hpp"
+#include "poker/thread_pool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+
+namespace poker {
+
+// ---------------------------------------------------------------------------
+// Betting tree
+
+BettingTree::BettingTree(const BettingConfig& config) : pot_(config.pot) {
+    if (config.pot <= 0 || config.stack < 0 || config.maxBets < 0) {
+        throw std::invalid_argument("BettingTree: pot must be positive and stack non-negative");
+    }
+    const int root = addNode(Decision, 0, 0, 0, Action::check());
+    expand(root, 0, 0, config, 1);
+}
+
+int BettingTree::addNode(Kind kind, int player, Chips c0, Chips c1, const Action& action) {
+    kind_.push_back(kind);
+    player_.push_back(static_cast<uint8_t>(player));
+    firstChild_.push_back(0);
+    childCount_.push_back(0);
+    committed_.push_back(c0);
+    committed_.push_back(c1);
+    action_.push_back(action);
+    return size() - 1;
+}
+
+void BettingTree::expand(int node, Chips lastRaise, int bets, const BettingConfig& config,
+                         int level) {
+    depth_ = std::max(depth_, level);
+    const int me = player_[node];
+    const int opp = 1 - me;
+    const Chips mine = committed(node, me);
+    const Chips theirs = committed(node, opp);
+    const Chips stack = config.stack;
+
+    struct Child {
+        Kind kind;
+        Action action;
+        Chips to;  // my commitment after the action
+    };
+    Child children[32];
+    int count = 0;
+    // Bet or raise targets, deduplicated and capped at all-in.
+    Chips targets[16];
+    int targetCount = 0;
+    const auto addTarget = [&](Chips to) {
+        to = std::min(to, stack);
+        if (to <= theirs) return;
+        for (int i = 0; i < targetCount; ++i) {
+            if (targets[i] == to) return;
+        }
+        if (targetCount < 16) targets[targetCount++] = to;
+    };
+
+    const bool facing = theirs > mine;
+    if (facing) {
+        children[count++] = {Fold, Action::fold(), mine};
+        children[count++] = {Showdown, Action::call(), theirs};
+        if (bets < config.maxBets && theirs < stack) {
+            const Chips potAfterCall = pot_ + 2 * theirs;
+            const Chips minTo = theirs + std::max<Chips>(lastRaise, 1);
+            for (double size : config.raiseSizes) {
+                addTarget(std::max<Chips>(minTo, theirs + std::llround(size * potAfterCall)));
+            }
+            if (config.allIn) addTarget(stack);
+        }
+    } else {
+        children[count++] = {me == 0 ? Decision : Showdown, Action::check(), mine};
+        if (bets < config.maxBets && mine < stack) {
+            const Chips pot = pot_ + mine + theirs;
+            for (double size : config.betSizes) {
+                addTarget(mine + std::max<Chips>(1, std::llround(size * pot)));
+            }
+            if (config.allIn) addTarget(stack);
+        }
+    }
+    std::sort(targets, targets + targetCount);
+    for (int i = 0; i < targetCount; ++i) {
+        children[count++] = {Decision, facing ? Action::raiseTo(targets[i])
+                                              : Action{Action::Bet, targets[i]},
+                             targets[i]};
+    }
+
+    const int first = size();
+    firstChild_[node] = first;
+    childCount_[node] = static_cast<uint8_t>(count);
+    maxActions_ = std::max(maxActions_, count);
+    for (int i = 0; i < count; ++i) {
+        const Chips c0 = me == 0 ? children[i].to : theirs;
+        const Chips c1 = me == 0 ? theirs : children[i].to;
+        // A fold node records the folder; decision nodes the next to act.
+        const int player = children[i].kind == Fold ? me : opp;
+        addNode(children[i].kind, player, c0, c1, children[i].action);
+    }
+    for (int i = 0; i < count; ++i) {
+        if (kind_[first + i] != Decision) continue;
+        const bool raised = children[i].to > theirs;
+        const Chips raise = raised ? children[i].to - theirs : lastRaise;
+        expand(first + i, raise, bets + (raised ? 1 : 0), config, level + 1);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// River subgame
+
+AbstractGame makeRiverGame(const Range& oop, const Range& ip, CardSet board,
+                           const BettingConfig& config) {
+    if (board.size() != 5) throw std::invalid_argument("makeRiverGame: board must be five cards");
+    AbstractGame game{BettingTree(config), {0, 0}, {}, {}, {}};
+    std::vector<Range::Combo> combos[2] = {oop.combos(board), ip.combos(board)};
+    for (int p = 0; p < 2; ++p) {
+        if (combos[p].empty()) throw std::invalid_argument("makeRiverGame: empty range");
+        game.hands[p] = static_cast<int>(combos[p].size());
+        for (const Range::Combo& c : combos[p]) game.cards[p].push_back(c.cards);
+    }
+    const size_t h0 = combos[0].size();
+    const size_t h1 = combos[1].size();
+    std::vector<HandValue> values[2];
+    for (int p = 0; p < 2; ++p) {
+        for (const Range::Combo& c : combos[p]) values[p].push_back(evaluate(c.cards | board));
+    }
+    game.deal.assign(h0 * h1, 0.0f);
+    game.equity.assign(h0 * h1, 0.0f);
+    double total = 0;
+    for (size_t i = 0; i < h0; ++i) {
+        for (size_t j = 0; j < h1; ++j) {
+            if (combos[0][i].cards.intersects(combos[1][j].cards)) continue;
+            const double w = double(combos[0][i].weight) * combos[1][j].weight;
+            game.deal[i * h1 + j] = static_cast<float>(w);
+            total += w;
+            game.equity[i * h1 + j] =
+                values[0][i] > values[1][j] ? 1.0f : values[0][i] == values[1][j] ? 0.5f : 0.0f;
+        }
+    }
+    if (total <= 0) throw std::invalid_argument("makeRiverGame: ranges cannot be dealt together");
+    for (float& w : game.deal) w = static_cast<float>(w / total);
+    return game;
+}
+
+// ---------------------------------------------------------------------------
+// Bucketed subgame
+
+AbstractGame makeBucketedGame(const Range& oop, const Range& ip, CardSet board,
+                              const BucketMap& map, const BettingConfig& config) {
+    if (board.size() < 3 || board.size() > 5) {
+        throw std::invalid_argument("makeBucketedGame: board must be three to five cards");
+    }
+    const Street street = static_cast<Street>(board.size() - 2);
+    if (!map.hasStreet(street)) {
+        throw std::invalid_argument("makeBucketedGame: bucket map does not cover the board's street");
+    }
+    std::vector<Range::Combo> combos[2] = {oop.combos(board), ip.combos(board)};
+    std::vector<int> buckets[2];
+    for (int p = 0; p < 2; ++p) {
+        if (combos[p].empty()) throw std::invalid_argument("makeBucketedGame: empty range");
+        for (const Range::Combo& c : combos[p]) {
+            buckets[p].push_back(map.bucket(c.cards, board));
+            if (buckets[p].back() < 0) {
+                throw std::runtime_error("makeBucketedGame: hand missing from bucket map");
+            }
+        }
+    }
+    const size_t h0 = combos[0].size();
+    const size_t h1 = combos[1].size();
+
+    // Every completion of the board, each once.
+    const CardSet live = CardSet::fullDeck() - board;
+    std::vector<CardSet> runouts;
+    if (board.size() == 5) runouts.push_back(CardSet());
+    for (Card a : live) {
+        if (board.size() == 4) runouts.push_back(CardSet(a));
+        if (board.size() != 3) continue;
+        for (Card b : live) {
+            if (b.id > a.id) runouts.push_back(CardSet(a) | CardSet(b));
+        }
+    }
+
+    // Player 0's showdown wins (ties count half) and the runouts that count,
+    // per combo pair.
+    std::vector<float> wins(h0 * h1, 0.0f);
+    std::vector<float> seen(h0 * h1, 0.0f);
+    std::vector<HandValue> values[2] = {std::vector<HandValue>(h0), std::vector<HandValue>(h1)};
+    for (CardSet runout : runouts) {
+        for (int p = 0; p < 2; ++p) {
+            for (size_t i = 0; i < combos[p].size(); ++i) {
+                values[p][i] = evaluate(combos[p][i].cards | board | runout);
+            }
+        }
+        for (size_t i = 0; i < h0; ++i) {
+            if (combos[0][i].cards.intersects(runout)) continue;
+            for (size_t j = 0; j < h1; ++j) {
+                const CardSet cards = combos[1][j].cards;
+                if (cards.intersects(runout) || cards.intersects(combos[0][i].cards)) continue;
+                wins[i * h1 + j] +=
+                    values[0][i] > values[1][j] ? 1.0f : values[0][i] == values[1][j] ? 0.5f : 0.0f;
+                seen[i * h1 + j] += 1.0f;
+            }
+        }
+    }
+
+    const int classes = map.buckets(street);
+    AbstractGame game{BettingTree(config), {classes, classes}, {}, {}, {}};
+    for (int p = 0; p < 2; ++p) game.cards[p].assign(classes, CardSet());
+    std::vector<double> deal(size_t(classes) * classes, 0.0);
+    std::vector<double> equity(deal.size(), 0.0);
+    double total = 0;
+    for (size_t i = 0; i < h0; ++i) {
+        for (size_t j = 0; j < h1; ++j) {
+            if (seen[i * h1 + j] == 0) continue;
+            const double w = double(combos[0][i].weight) * combos[1][j].weight;
+            const size_t cell = size_t(buckets[0][i]) * classes + buckets[1][j];
+            deal[cell] += w;
+            equity[cell] += w * wins[i * h1 + j] / seen[i * h1 + j];
+            total += w;
+        }
+    }
+    if (total <= 0) throw std::invalid_argument("makeBucketedGame: ranges cannot be dealt together");
+    game.deal.resize(deal.size());
+    game.equity.resize(deal.size());
+    for (size_t cell = 0; cell < deal.size(); ++cell) {
+        game.deal[cell] = static_cast<float>(deal[cell] / total);
+        game.equity[cell] = deal[cell] > 0 ? static_cast<float>(equity[cell] / deal[cell]) : 0.0f;
+    }
+    return game;
+}
+
+// ---------------------------------------------------------------------------
+// Solver
+
+namespace {
+
+enum Mode { kUpdate, kBestResponse, kEvaluate };
+
+// Slices per worker, so uneven slices still balance.
+constexpr int kSlicesPerWorker = 4;
+
+// Dot products of matrix rows with a vector. Eight partial sums let the
+// compiler keep them in vector lanes without reassociating the reduction.
+void matVec(const float* matrix, size_t columns, size_t rowBegin, size_t rowEnd,
+            const float* vector, float* out) {
+    for (size_t r = rowBegin; r < rowEnd; ++r) {
+        const float* row = matrix + r * columns;
+        float acc[8] = {};
+        size_t c = 0;
+        for (; c + 8 <= columns; c += 8) {
+            for (int l = 0; l < 8; ++l) acc[l] += row[c + l] * vector[c + l];
+        }
+        float sum = 0;
+        for (; c < columns; ++c) sum += row[c] * vector[c];
+        for (float a : acc) sum += a;
+        out[r - rowBegin] = sum;
+    }
+}
+
+// Regret matching (current strategy) or normalized sums (average strategy).
+void normalize(const float* weights, int actions, float* out) {
+    float sum = 0;
+    for (int a = 0; a < actions; ++a) sum += weights[a];
+    if (sum > 0) {
+        for (int a = 0; a < actions; ++a) out[a] = weights[a] / sum;
+    } else {
+        for (int a = 0; a < actions; ++a) out[a] = 1.0f / actions;
+    }
+}
+
+} // namespace
+
+struct CfrSolver::Scratch {
+    const CfrSolver* solver;
+    Arena* arena;
+    int player;      // traverser
+    Mode mode;
+    size_t begin;    // traverser hand slice
+    size_t end;
+    float weight;    // strategy-sum weight of this iteration
+    float* regrets;  // written in kUpdate mode only
+    float* sums;
+
+    float* floats(size_t count) { return arena->allocateArray<float>(count); }
+
+    // Counterfactual values of the slice's hands at `node` into `out`.
+    void walk(int node, const float* ownReach, const float* oppReach, float* out) {
+        const AbstractGame& game = solver->game_;
+        const BettingTree& tree = game.tree;
+        const size_t n = end - begin;
+        const int opp = 1 - player;
+        const size_t oppHands = static_cast<size_t>(game.hands[opp]);
+        const float* deal = player == 0 ? game.deal.data() : solver->dealT_.data();
+        const size_t mark = arena->used();
+
+        switch (tree.kind(node)) {
+        case BettingTree::Fold: {
+            const double mine = double(tree.committed(node, player));
+            const double theirs = double(tree.committed(node, opp));
+            const float payoff = static_cast<float>(
+                tree.player(node) == player ? -mine : double(tree.pot()) + theirs);
+            matVec(deal, oppHands, begin, end, oppReach, out);
+            for (size_t h = 0; h < n; ++h) out[h] *= payoff;
+            break;
+        }
+        case BettingTree::Showdown: {
+            const float committed = static_cast<float>(tree.committed(node, player));
+            const float pot = static_cast<float>(tree.pot()) + 2 * committed;
+            float* reach = floats(n);
+            matVec(deal, oppHands, begin, end, oppReach, reach);
+            matVec(solver->winDeal_[player].data(), oppHands, begin, end, oppReach, out);
+            for (size_t h = 0; h < n; ++h) out[h] = pot * out[h] - committed * reach[h];
+            break;
+        }
+        case BettingTree::Decision: {
+            const int first = tree.firstChild(node);
+            const int k = tree.childCount(node);
+            const uint32_t offset = solver->offset_[node];
+            float sigma[32];
+            if (tree.player(node) != player) {
+                // Opponent: split its reach by its strategy and sum values.
+                const float* table = mode == kUpdate ? solver->regrets_.data()
+                                                     : solver->strategySum_.data();
+                float* reach = floats(oppHands * k);
+                for (size_t o = 0; o < oppHands; ++o) {
+                    normalize(table + offset + o * k, k, sigma);
+                    for (int a = 0; a < k; ++a) reach[a * oppHands + o] = oppReach[o] * sigma[a];
+                }
+                float* child = floats(n);
+                std::fill(out, out + n, 0.0f);
+                for (int a = 0; a < k; ++a) {
+                    walk(first + a, ownReach, reach + a * oppHands, child);
+                    for (size_t h = 0; h < n; ++h) out[h] += child[h];
+                }
+                break;
+            }
+            float* values = floats(n * k);
+            if (mode == kBestResponse) {
+                for (int a = 0; a < k; ++a) walk(first + a, ownReach, oppReach, values + a * n);
+                for (size_t h = 0; h < n; ++h) {
+                    float best = values[h];
+                    for (int a = 1; a < k; ++a) best = std::max(best, values[a * n + h]);
+                    out[h] = best;
+                }
+                break;
+            }
+            const float* table = mode == kUpdate ? solver->regrets_.data()
+                                                 : solver->strategySum_.data();
+            float* strategy = floats(n * k);
+            float* childReach = floats(n * k);
+            for (size_t h = 0; h < n; ++h) {
+                normalize(table + offset + (begin + h) * k, k, strategy + h * k);
+                for (int a = 0; a < k; ++a) childReach[a * n + h] = ownReach[h] * strategy[h * k + a];
+            }
+            for (int a = 0; a < k; ++a) walk(first + a, childReach + a * n, oppReach, values + a * n);
+            for (size_t h = 0; h < n; ++h) {
+                float v = 0;
+                for (int a = 0; a < k; ++a) v += strategy[h * k + a] * values[a * n + h];
+                out[h] = v;
+            }
+            if (mode != kUpdate) break;
+            // CFR+: regrets floored at zero; averages weighted by iteration.
+            float* nodeRegrets = regrets + offset + begin * k;
+            float* nodeSums = sums + offset + begin * k;
+            for (size_t h = 0; h < n; ++h) {
+                for (int a = 0; a < k; ++a) {
+                    float& r = nodeRegrets[h * k + a];
+                    r = std::max(0.0f, r + values[a * n + h] - out[h]);
+                    nodeSums[h * k + a] += weight * ownReach[h] * strategy[h * k + a];
+                }
+            }
+            break;
+        }
+        }
+        arena->rewind(mark);
+    }
+};
+
+CfrSolver::CfrSolver(const AbstractGame& game, const SolverOptions& options)
+    : game_(game), pool_(options.pool ? *options.pool : ThreadPool::shared()), options_(options) {
+    const BettingTree& tree = game.tree;
+    const size_t h0 = static_cast<size_t>(game.hands[0]);
+    const size_t h1 = static_cast<size_t>(game.hands[1]);
+    if (h0 == 0 || h1 == 0 || game.deal.size() != h0 * h1 || game.equity.size() != h0 * h1) {
+        throw std::invalid_argument("CfrSolver: game matrices do not match the hand counts");
+    }
+    size_t entries = 0;
+    offset_.assign(tree.size(), 0);
+    for (int node = 0; node < tree.size(); ++node) {
+        if (tree.kind(node) != BettingTree::Decision) continue;
+        offset_[node] = static_cast<uint32_t>(entries);
+        entries += static_cast<size_t>(game.hands[tree.player(node)]) * tree.childCount(node);
+    }
+    const size_t bytes = 2 * entries * sizeof(float) + 4 * h0 * h1 * sizeof(float);
+    if (options.maxMemoryBytes && bytes > options.maxMemoryBytes) {
+        throw std::invalid_argument("CfrSolver: game needs more memory than maxMemoryBytes");
+    }
+    regrets_.assign(entries, 0.0f);
+    strategySum_.assign(entries, 0.0f);
+    dealT_.resize(h0 * h1);
+    winDeal_[0].resize(h0 * h1);
+    winDeal_[1].resize(h0 * h1);
+    for (size_t i = 0; i < h0; ++i) {
+        for (size_t j = 0; j < h1; ++j) {
+            const float d = game.deal[i * h1 + j];
+            const float e = game.equity[i * h1 + j];
+            dealT_[j * h0 + i] = d;
+            winDeal_[0][i * h1 + j] = d * e;
+            winDeal_[1][j * h0 + i] = d * (1.0f - e);
+        }
+    }
+}
+
+size_t CfrSolver::memoryBytes() const {
+    return (regrets_.size() + strategySum_.size() + dealT_.size() + winDeal_[0].size() +
+            winDeal_[1].size()) *
+           sizeof(float);
+}
+
+double CfrSolver::traverse(int player, int mode, float* regrets, float* sums) const {
+    POKER_PROFILE_SCOPE(CfrTraverse);
+    const size_t hands = static_cast<size_t>(game_.hands[player]);
+    const size_t oppHands = static_cast<size_t>(game_.hands[1 - player]);
+    const size_t slices = std::min(hands, size_t{pool_.size()} * kSlicesPerWorker);
+    const size_t maxHands = std::max(hands, oppHands);
+    const int k = game_.tree.maxActions();
+    // Per level: opponent reach split k ways, or values, strategy and reach
+    // k ways each, plus one child vector; with slack for alignment.
+    const size_t arenaBytes =
+        size_t(game_.tree.depth() + 1) * (3 * size_t(k) + 2) * maxHands * sizeof(float) +
+        size_t(game_.tree.depth() + 1) * 8 * 64;
+
+    std::vector<std::unique_ptr<Arena>> arenas(pool_.size());
+    for (auto& a : arenas) a = std::make_unique<Arena>(arenaBytes);
+    std::vector<double> totals(slices, 0.0);
+    const float weight = static_cast<float>(std::max(0, iterations_ - options_.averagingDelay));
+
+    pool_.parallelFor(slices, [&](size_t slice, unsigned worker) {
+        Arena& arena = *arenas[worker];
+        arena.reset();
+        Scratch s{this, &arena, player, static_cast<Mode>(mode), hands * slice / slices,
+                  hands * (slice + 1) / slices, weight, regrets, sums};
+        const size_t n = s.end - s.begin;
+        float* ownReach = s.floats(n);
+        float* oppReach = s.floats(oppHands);
+        float* values = s.floats(n);
+        std::fill(ownReach, ownReach + n, 1.0f);
+        std::fill(oppReach, oppReach + oppHands, 1.0f);
+        s.walk(0, ownReach, oppReach, values);
+        double sum = 0;
+        for (size_t h = 0; h < n; ++h) sum += values[h];
+        totals[slice] = sum;
+    });
+    double total = 0;
+    for (double t : totals) total += t;
+    return total;
+}
+
+void CfrSolver::update(int player) {
+    traverse(player, kUpdate, regrets_.data(), strategySum_.data());
+}
+
+void CfrSolver::iterate(int iterations) {
+    POKER_PROFILE_SCOPE(CfrIterate);
+    POKER_PROFILE_COUNT(CfrIterations, iterations);
+    for (int i = 0; i < iterations; ++i) {
+        ++iterations_;
+        update(0);
+        update(1);
+    }
+}
+
+void CfrSolver::averageStrategy(int node, int hand, float* out) const {
+    const int k = game_.tree.childCount(node);
+    normalize(strategySum_.data() + offset_[node] + size_t(hand) * k, k, out);
+}
+
+double CfrSolver::exploitability() const {
+    const double br0 = traverse(0, kBestResponse, nullptr, nullptr);
+    const double br1 = traverse(1, kBestResponse, nullptr, nullptr);
+    return (br0 + br1 - double(game_.tree.pot())) / 2;
+}
+
+double CfrSolver::value() const { return traverse(0, kEvaluate, nullptr, nullptr); }
+
+} // namespace poker
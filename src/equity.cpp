@@ -0,0 +1,562 @@
+#include "poker/equity.hpp"
+
+#include "poker/combinatorics.hpp"
+#include "poker/evaluator.hpp"
+#include "poker/profile.hpp"
+#include "poker/rng.hpp"
+#include "poker/thread_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace poker {
+
+namespace {
+
+// Pot shares are counted in units of lcm(1..10) so splits stay integral.
+constexpr uint64_t kShareUnit = 2520;
+constexpr uint64_t kTrialsPerTask = 4096;
+constexpr int kMaxRedraws = 64;
+constexpr uint64_t kShowdownsPerTask = 16384;
+constexpr int kExactBatch = 64;
+constexpr size_t kMaxExactDeals = size_t{1} << 22;
+
+template <class Variant>
+void validate(int players, CardSet board, CardSet dead, const char* who) {
+    if (players < 2 || players > kMaxEquityPlayers) {
+        throw std::invalid_argument(std::string(who) + ": need 2 to 10 players");
+    }
+    if (board.size() > 5) {
+        throw std::invalid_argument(std::string(who) + ": board has more than 5 cards");
+    }
+    if (board.intersects(dead)) {
+        throw std::invalid_argument(std::string(who) + ": board and dead cards overlap");
+    }
+    if (!CardSet(Variant::kDeckBits).containsAll(board)) {
+        throw std::invalid_argument(std::string(who) + ": board card outside the deck");
+    }
+    // The dealers draw by rejection and would never finish a deal the deck
+    // cannot cover.
+    const int needed = players * Variant::kHoleCards + 5 - board.size();
+    const int available = kDeckSize<Variant> - popcount((board | dead).bits() & Variant::kDeckBits);
+    if (needed > available) {
+        throw std::invalid_argument(std::string(who) + ": not enough cards left to deal");
+    }
+}
+
+// Cards that can never be dealt: the dead cards, the board and whatever the
+// variant's deck leaves out.
+template <class Variant>
+CardSet blockedCards(CardSet board, CardSet dead) {
+    return board | dead | ~CardSet(Variant::kDeckBits);
+}
+
+// The combos of one range that can be dealt at all, i.e. miss the board and
+// the dead cards.
+std::vector<Range::Combo> liveCombos(const Range& range, CardSet blocked, const char* who) {
+    std::vector<Range::Combo> live = range.combos(blocked);
+    if (live.empty()) throw std::invalid_argument(std::string(who) + ": empty range");
+    return live;
+}
+
+// Outcome of one showdown for the hero (values[0]).
+struct Showdown {
+    enum Kind { Win, Tie, Loss } kind;
+    uint64_t share;
+};
+
+Showdown scoreShowdown(const HandValue* values, int players) {
+    HandValue bestVillain = 0;
+    int villainsTied = 0;
+    for (int p = 1; p < players; ++p) {
+        if (values[p] > bestVillain) {
+            bestVillain = values[p];
+            villainsTied = 1;
+        } else if (values[p] == bestVillain) {
+            ++villainsTied;
+        }
+    }
+    if (values[0] > bestVillain) return {Showdown::Win, kShareUnit};
+    if (values[0] == bestVillain) return {Showdown::Tie, kShareUnit / (1 + villainsTied)};
+    return {Showdown::Loss, 0};
+}
+
+// Draws combos of one range in proportion to their weights.
+class ComboSampler {
+public:
+    explicit ComboSampler(const std::vector<Range::Combo>& combos) {
+        for (const Range::Combo& combo : combos) {
+            total_ += combo.weight;
+            cards_.push_back(combo.cards);
+            cumulative_.push_back(total_);
+        }
+    }
+
+    CardSet draw(Rng& rng) const {
+        const double target = rng.uniform() * total_;
+        const size_t i = std::upper_bound(cumulative_.begin(), cumulative_.end(), target) -
+                         cumulative_.begin();
+        return cards_[std::min(i, cards_.size() - 1)];
+    }
+
+private:
+    std::vector<CardSet> cards_;
+    std::vector<double> cumulative_;
+    double total_ = 0.0;
+};
+
+// Running totals owned by one worker. Only the owner writes; other workers
+// read them when checking the stopping rule, hence the relaxed atomics and the
+// cache-line alignment.
+struct alignas(64) WorkerTally {
+    std::atomic<uint64_t> trials{0};
+    std::atomic<uint64_t> wins{0};
+    std::atomic<uint64_t> ties{0};
+    std::atomic<uint64_t> losses{0};
+    std::atomic<uint64_t> share{0};
+    std::atomic<uint64_t> shareSquared{0};
+};
+
+struct Totals {
+    uint64_t trials = 0, wins = 0, ties = 0, losses = 0, share = 0, shareSquared = 0;
+};
+
+void publish(std::atomic<uint64_t>& slot, uint64_t delta) {
+    slot.store(slot.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+Totals sumTallies(const WorkerTally* tallies, unsigned count) {
+    Totals t;
+    for (unsigned w = 0; w < count; ++w) {
+        t.trials += tallies[w].trials.load(std::memory_order_relaxed);
+        t.wins += tallies[w].wins.load(std::memory_order_relaxed);
+        t.ties += tallies[w].ties.load(std::memory_order_relaxed);
+        t.losses += tallies[w].losses.load(std::memory_order_relaxed);
+        t.share += tallies[w].share.load(std::memory_order_relaxed);
+        t.shareSquared += tallies[w].shareSquared.load(std::memory_order_relaxed);
+    }
+    return t;
+}
+
+double meanShare(const Totals& t) {
+    return t.trials ? double(t.share) / (double(kShareUnit) * t.trials) : 0.0;
+}
+
+double shareStdError(const Totals& t) {
+    if (t.trials < 2) return 0.0;
+    const double n = double(t.trials);
+    const double mean = meanShare(t);
+    const double meanSquare = double(t.shareSquared) / (double(kShareUnit) * kShareUnit * n);
+    return std::sqrt(std::max(0.0, meanSquare - mean * mean) / n);
+}
+
+// Deals every player a combo of their range, redrawing the whole deal when
+// combos collide.
+class RangeDealer {
+public:
+    RangeDealer(const Range& hero, const std::vector<Range>& villains, CardSet blocked,
+                const char* who) {
+        samplers_.reserve(1 + villains.size());
+        samplers_.emplace_back(liveCombos(hero, blocked, who));
+        for (const Range& villain : villains) samplers_.emplace_back(liveCombos(villain, blocked, who));
+    }
+
+    int players() const { return static_cast<int>(samplers_.size()); }
+
+    bool deal(Rng& rng, CardSet blocked, CardSet& used, CardSet* hands) const {
+        const int players = this->players();
+        for (int attempt = 0; attempt < kMaxRedraws; ++attempt) {
+            used = blocked;
+            bool dealt = true;
+            for (int p = 0; p < players; ++p) {
+                hands[p] = samplers_[p].draw(rng);
+                if (hands[p].intersects(used)) {
+                    dealt = false;
+                    break;
+                }
+                used |= hands[p];
+            }
+            if (dealt) return true;
+        }
+        return false;
+    }
+
+private:
+    std::vector<ComboSampler> samplers_;
+};
+
+// Known hands stay put; empty ones get random hole cards from the deck.
+template <class Variant>
+class HandDealer {
+public:
+    explicit HandDealer(const std::vector<CardSet>& hands) : hands_(hands) {}
+
+    int players() const { return static_cast<int>(hands_.size()); }
+
+    bool deal(Rng& rng, CardSet blocked, CardSet& used, CardSet* hands) const {
+        const int players = this->players();
+        used = blocked;
+        for (int p = 0; p < players; ++p) used |= hands_[p];
+        for (int p = 0; p < players; ++p) {
+            hands[p] = hands_[p];
+            for (int missing = hands[p].empty() ? Variant::kHoleCards : 0; missing > 0;) {
+                const Card card = kDeckCards<Variant>[rng.below(kDeckSize<Variant>)];
+                if (used.contains(card)) continue;
+                used.add(card);
+                hands[p].add(card);
+                --missing;
+            }
+        }
+        return true;
+    }
+
+private:
+    const std::vector<CardSet>& hands_;
+};
+
+template <class Variant>
+void validateHands(const std::vector<CardSet>& hands, CardSet board, CardSet dead, bool allKnown,
+                   const char* who) {
+    validate<Variant>(static_cast<int>(hands.size()), board, dead, who);
+    CardSet seen = board | dead;
+    for (CardSet hand : hands) {
+        if (hand.empty() && !allKnown) continue;
+        if (hand.size() != Variant::kHoleCards) {
+            throw std::invalid_argument(std::string(who) + ": hand has the wrong number of cards");
+        }
+        if (!CardSet(Variant::kDeckBits).containsAll(hand)) {
+            throw std::invalid_argument(std::string(who) + ": hand card outside the deck");
+        }
+        if (hand.intersects(seen)) throw std::invalid_argument(std::string(who) + ": cards overlap");
+        seen |= hand;
+    }
+}
+
+// Every non-colliding deal of the ranges, hands stored player-major per deal.
+struct DealList {
+    int players = 0;
+    std::vector<CardSet> hands;
+    std::vector<double> weights;
+
+    size_t size() const { return weights.size(); }
+};
+
+void collectDeals(const std::vector<std::vector<Range::Combo>>& live, int player, CardSet used,
+                  double weight, CardSet* current, DealList& out) {
+    if (player == out.players) {
+        if (out.size() >= kMaxExactDeals) {
+            throw std::invalid_argument("exactEquity: ranges too large for exact enumeration");
+        }
+        out.hands.insert(out.hands.end(), current, current + out.players);
+        out.weights.push_back(weight);
+        return;
+    }
+    for (const Range::Combo& combo : live[player]) {
+        if (combo.cards.intersects(used)) continue;
+        current[player] = combo.cards;
+        collectDeals(live, player + 1, used | combo.cards, weight * combo.weight, current, out);
+    }
+}
+
+uint64_t countDeals(const std::vector<std::vector<Range::Combo>>& live, size_t player,
+                    CardSet used) {
+    if (player == live.size()) return 1;
+    uint64_t count = 0;
+    for (const Range::Combo& combo : live[player]) {
+        if (!combo.cards.intersects(used)) count += countDeals(live, player + 1, used | combo.cards);
+    }
+    return count;
+}
+
+DealList enumerateDeals(const Range& hero, const std::vector<Range>& villains, CardSet blocked) {
+    std::vector<std::vector<Range::Combo>> live;
+    live.push_back(liveCombos(hero, blocked, "exactEquity"));
+    for (const Range& villain : villains) live.push_back(liveCombos(villain, blocked, "exactEquity"));
+    DealList deals;
+    deals.players = static_cast<int>(live.size());
+    CardSet current[kMaxEquityPlayers];
+    collectDeals(live, 0, blocked, 1.0, current, deals);
+    if (deals.size() == 0) {
+        throw std::invalid_argument("exactEquity: ranges cannot be dealt together");
+    }
+    return deals;
+}
+
+// Weighted outcome totals of one exact-enumeration task.
+struct ExactTotals {
+    uint64_t showdowns = 0;
+    double weight = 0.0;
+    double win = 0.0;
+    double tie = 0.0;
+    double loss = 0.0;
+    double share = 0.0;
+};
+
+// The Monte Carlo loop shared by every variant and dealer. Only the dealer
+// and the variant's deck and evaluator differ; both are compile-time.
+template <class Variant, class Dealer>
+EquityResult runMonteCarlo(const Dealer& dealer, CardSet board, CardSet blocked,
+                           const MonteCarloOptions& options, const char* who) {
+    const int players = dealer.players();
+    initEvaluator<typename Variant::Ranking>();
+    ThreadPool& pool = options.pool ? *options.pool : ThreadPool::shared();
+    const std::unique_ptr<WorkerTally[]> tallies(new WorkerTally[pool.size()]);
+    std::atomic<bool> stop{false};
+
+    const int boardMissing = 5 - board.size();
+    const uint64_t tasks = (options.maxTrials + kTrialsPerTask - 1) / kTrialsPerTask;
+    pool.parallelFor(tasks, [&](size_t task, unsigned worker) {
+        if (stop.load(std::memory_order_relaxed)) return;
+        Rng rng = Rng::forStream(options.seed, task);
+        const uint64_t first = task * kTrialsPerTask;
+        const uint64_t count = std::min(kTrialsPerTask, options.maxTrials - first);
+
+        Totals local;
+        for (uint64_t trial = 0; trial < count; ++trial) {
+            CardSet used;
+            CardSet hands[kMaxEquityPlayers];
+            if (!dealer.deal(rng, blocked, used, hands)) continue;
+
+            CardSet fullBoard = board;
+            for (int missing = boardMissing; missing > 0;) {
+                const Card card = kDeckCards<Variant>[rng.below(kDeckSize<Variant>)];
+                if (used.contains(card)) continue;
+                used.add(card);
+                fullBoard.add(card);
+                --missing;
+            }
+
+            HandValue values[kMaxEquityPlayers];
+            for (int p = 0; p < players; ++p) values[p] = showdownValue<Variant>(hands[p], fullBoard);
+            const Showdown showdown = scoreShowdown(values, players);
+            local.wins += showdown.kind == Showdown::Win;
+            local.ties += showdown.kind == Showdown::Tie;
+            local.losses += showdown.kind == Showdown::Loss;
+            ++local.trials;
+            local.share += showdown.share;
+            local.shareSquared += showdown.share * showdown.share;
+        }
+
+        WorkerTally& tally = tallies[worker];
+        publish(tally.trials, local.trials);
+        publish(tally.wins, local.wins);
+        publish(tally.ties, local.ties);
+        publish(tally.losses, local.losses);
+        publish(tally.share, local.share);
+        publish(tally.shareSquared, local.shareSquared);
+
+        if (options.targetHalfWidth > 0.0) {
+            const Totals t = sumTallies(tallies.get(), pool.size());
+            if (t.trials >= options.minTrials &&
+                options.confidenceZ * shareStdError(t) <= options.targetHalfWidth) {
+                stop.store(true, std::memory_order_relaxed);
+            }
+        }
+    });
+
+    // Decided from the whole run: a task that drew only collisions says
+    // little about ranges that rarely fit together.
+    const Totals t = sumTallies(tallies.get(), pool.size());
+    if (t.trials == 0 && tasks > 0) {
+        throw std::invalid_argument(std::string(who) + ": ranges cannot be dealt together");
+    }
+    EquityResult result;
+    result.trials = t.trials;
+    if (t.trials > 0) {
+        result.win = double(t.wins) / t.trials;
+        result.tie = double(t.ties) / t.trials;
+        result.loss = double(t.losses) / t.trials;
+    }
+    result.equity = meanShare(t);
+    result.stdError = shareStdError(t);
+    return result;
+}
+
+// The exact enumeration shared by every variant. Variants that let the best
+// five of all cards play go through the batch evaluator; Omaha evaluates each
+// hand on the spot.
+template <class Variant>
+EquityResult runExact(const DealList& deals, CardSet board, CardSet blocked, const ExactOptions& options) {
+    const int players = deals.players;
+    const int missing = 5 - board.size();
+    const int remaining = kNumCards - blocked.size() - Variant::kHoleCards * players;
+    const uint64_t boards = choose(remaining, missing);
+    const uint64_t showdowns = deals.size() * boards;
+
+    initEvaluator<typename Variant::Ranking>();
+    ThreadPool& pool = options.pool ? *options.pool : ThreadPool::shared();
+    const uint64_t tasks = (showdowns + kShowdownsPerTask - 1) / kShowdownsPerTask;
+    std::vector<ExactTotals> taskTotals(tasks);
+
+    pool.parallelFor(tasks, [&](size_t task, unsigned) {
+        ExactTotals& totals = taskTotals[task];
+        CardSet batch[kMaxEquityPlayers][kExactBatch];
+        HandValue values[kMaxEquityPlayers][kExactBatch];
+        uint64_t next = task * kShowdownsPerTask;
+        const uint64_t end = std::min(showdowns, next + kShowdownsPerTask);
+        while (next < end) {
+            const uint64_t deal = next / boards;
+            const uint64_t firstBoard = next % boards;
+            const uint64_t count = std::min(end - next, boards - firstBoard);
+            const CardSet* hands = &deals.hands[deal * players];
+
+            CardSet used = blocked;
+            for (int p = 0; p < players; ++p) used |= hands[p];
+            Card available[kNumCards];
+            int availableCount = 0;
+            for (Card card : ~used) available[availableCount++] = card;
+
+            int positions[5];
+            colexUnrank(firstBoard, missing, positions);
+            uint64_t wins = 0, ties = 0, losses = 0, share = 0;
+            for (uint64_t done = 0; done < count;) {
+                const int n = static_cast<int>(std::min<uint64_t>(kExactBatch, count - done));
+                for (int i = 0; i < n; ++i) {
+                    CardSet fullBoard = board;
+                    for (int j = 0; j < missing; ++j) fullBoard.add(available[positions[j]]);
+                    if constexpr (Variant::kHoleCardsUsed == 0) {
+                        for (int p = 0; p < players; ++p) batch[p][i] = hands[p] | fullBoard;
+                    } else {
+                        for (int p = 0; p < players; ++p) {
+                            values[p][i] = showdownValue<Variant>(hands[p], fullBoard);
+                        }
+                    }
+                    colexNext(positions, missing);
+                }
+                if constexpr (Variant::kHoleCardsUsed == 0) {
+                    for (int p = 0; p < players; ++p) {
+                        evaluateBatch<typename Variant::Ranking>(batch[p], values[p], n);
+                    }
+                }
+                for (int i = 0; i < n; ++i) {
+                    HandValue showdownValues[kMaxEquityPlayers];
+                    for (int p = 0; p < players; ++p) showdownValues[p] = values[p][i];
+                    const Showdown showdown = scoreShowdown(showdownValues, players);
+                    wins += showdown.kind == Showdown::Win;
+                    ties += showdown.kind == Showdown::Tie;
+                    losses += showdown.kind == Showdown::Loss;
+                    share += showdown.share;
+                }
+                done += n;
+            }
+
+            const double weight = deals.weights[deal];
+            totals.showdowns += count;
+            totals.weight += weight * count;
+            totals.win += weight * wins;
+            totals.tie += weight * ties;
+            totals.loss += weight * losses;
+            totals.share += weight * share;
+            next += count;
+        }
+    });
+
+    ExactTotals sum;
+    for (const ExactTotals& t : taskTotals) {
+        sum.showdowns += t.showdowns;
+        sum.weight += t.weight;
+        sum.win += t.win;
+        sum.tie += t.tie;
+        sum.loss += t.loss;
+        sum.share += t.share;
+    }
+    EquityResult result;
+    result.trials = sum.showdowns;
+    if (sum.weight > 0.0) {
+        result.win = sum.win / sum.weight;
+        result.tie = sum.tie / sum.weight;
+        result.loss = sum.loss / sum.weight;
+        result.equity = sum.share / (double(kShareUnit) * sum.weight);
+    }
+    return result;
+}
+
+} // namespace
+
+template <class Variant>
+EquityResult monteCarloEquity(const Range& hero, const std::vector<Range>& villains,
+                              CardSet board, const MonteCarloOptions& options) {
+    static_assert(Variant::kHoleCards == 2, "ranges hold two-card combos");
+    POKER_PROFILE_SCOPE(EquityMonteCarlo);
+    validate<Variant>(1 + static_cast<int>(villains.size()), board, options.dead, "monteCarloEquity");
+    const CardSet blocked = blockedCards<Variant>(board, options.dead);
+    const RangeDealer dealer(hero, villains, blocked, "monteCarloEquity");
+    const EquityResult result = runMonteCarlo<Variant>(dealer, board, blocked, options, "monteCarloEquity");
+    POKER_PROFILE_COUNT(EquityTrials, result.trials);
+    return result;
+}
+
+template <class Variant>
+EquityResult exactEquity(const Range& hero, const std::vector<Range>& villains, CardSet board,
+                         const ExactOptions& options) {
+    static_assert(Variant::kHoleCards == 2, "ranges hold two-card combos");
+    POKER_PROFILE_SCOPE(EquityExact);
+    validate<Variant>(1 + static_cast<int>(villains.size()), board, options.dead, "exactEquity");
+    const CardSet blocked = blockedCards<Variant>(board, options.dead);
+    const EquityResult result = runExact<Variant>(enumerateDeals(hero, villains, blocked), board, blocked, options);
+    POKER_PROFILE_COUNT(EquityTrials, result.trials);
+    return result;
+}
+
+template <class Variant>
+uint64_t exactShowdownCount(const Range& hero, const std::vector<Range>& villains, CardSet board,
+                            CardSet dead) {
+    static_assert(Variant::kHoleCards == 2, "ranges hold two-card combos");
+    validate<Variant>(1 + static_cast<int>(villains.size()), board, dead, "exactShowdownCount");
+    const CardSet blocked = blockedCards<Variant>(board, dead);
+    std::vector<std::vector<Range::Combo>> live;
+    live.push_back(liveCombos(hero, blocked, "exactShowdownCount"));
+    for (const Range& villain : villains) {
+        live.push_back(liveCombos(villain, blocked, "exactShowdownCount"));
+    }
+    const int remaining = kNumCards - blocked.size() - 2 * static_cast<int>(live.size());
+    return countDeals(live, 0, blocked) * choose(remaining, 5 - board.size());
+}
+
+template <class Variant>
+EquityResult handEquity(const std::vector<CardSet>& hands, CardSet board, const MonteCarloOptions& options) {
+    POKER_PROFILE_SCOPE(EquityMonteCarlo);
+    validateHands<Variant>(hands, board, options.dead, false, "handEquity");
+    const CardSet blocked = blockedCards<Variant>(board, options.dead);
+    const HandDealer<Variant> dealer(hands);
+    const EquityResult result = runMonteCarlo<Variant>(dealer, board, blocked, options, "handEquity");
+    POKER_PROFILE_COUNT(EquityTrials, result.trials);
+    return result;
+}
+
+template <class Variant>
+EquityResult exactHandEquity(const std::vector<CardSet>& hands, CardSet board, const ExactOptions& options) {
+    POKER_PROFILE_SCOPE(EquityExact);
+    validateHands<Variant>(hands, board, options.dead, true, "exactHandEquity");
+    const CardSet blocked = blockedCards<Variant>(board, options.dead);
+    DealList deals;
+    deals.players = static_cast<int>(hands.size());
+    deals.hands = hands;
+    deals.weights.push_back(1.0);
+    const EquityResult result = runExact<Variant>(deals, board, blocked, options);
+    POKER_PROFILE_COUNT(EquityTrials, result.trials);
+    return result;
+}
+
+template EquityResult monteCarloEquity<Holdem>(const Range&, const std::vector<Range>&, CardSet,
+                                               const MonteCarloOptions&);
+template EquityResult monteCarloEquity<ShortDeck>(const Range&, const std::vector<Range>&, CardSet,
+                                                  const MonteCarloOptions&);
+template EquityResult exactEquity<Holdem>(const Range&, const std::vector<Range>&, CardSet,
+                                          const ExactOptions&);
+template EquityResult exactEquity<ShortDeck>(const Range&, const std::vector<Range>&, CardSet,
+                                             const ExactOptions&);
+template uint64_t exactShowdownCount<Holdem>(const Range&, const std::vector<Range>&, CardSet, CardSet);
+template uint64_t exactShowdownCount<ShortDeck>(const Range&, const std::vector<Range>&, CardSet, CardSet);
+template EquityResult handEquity<Holdem>(const std::vector<CardSet>&, CardSet, const MonteCarloOptions&);
+template EquityResult handEquity<ShortDeck>(const std::vector<CardSet>&, CardSet, const MonteCarloOptions&);
+template EquityResult handEquity<Omaha>(const std::vector<CardSet>&, CardSet, const MonteCarloOptions&);
+template EquityResult exactHandEquity<Holdem>(const std::vector<CardSet>&, CardSet, const ExactOptions&);
+template EquityResult exactHandEquity<ShortDeck>(const std::vector<CardSet>&, CardSet, const ExactOptions&);
+template EquityResult exactHandEquity<Omaha>(const std::vector<CardSet>&, CardSet, const ExactOptions&);
+
+} // namespace poker
@@ -0,0 +1,293 @@
+#include "poker/equity_cache.hpp"
+
+#include "poker/rng.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace poker {
+
+struct EquityCache::Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t shardCount;
+    uint64_t slotsPerShard;
+    uint64_t reserved[5];
+};
+
+struct EquityCache::Slot {
+    uint64_t keyHi;
+    uint64_t keyLo;           ///< 0 marks an empty slot; real keys are odd
+    uint64_t trials;
+    double win;
+    double tie;
+    double loss;
+    double equity;
+    double stdError;
+};
+
+namespace {
+
+constexpr char kMagic[8] = {'P', 'K', 'E', 'Q', 'C', 'A', 'C', 'H'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t kMaxProbe = 8;
+
+bool isPowerOfTwo(uint64_t n) { return n && (n & (n - 1)) == 0; }
+
+uint64_t roundUpPowerOfTwo(uint64_t n) {
+    uint64_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+[[noreturn]] void fail(const std::string& path, const char* what) {
+    throw std::runtime_error("EquityCache: " + path + ": " + what);
+}
+
+bool writeAll(int fd, const void* data, size_t size) {
+    const char* p = static_cast<const char*>(data);
+    while (size > 0) {
+        const ssize_t n = ::write(fd, p, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+uint64_t doubleBits(double d) {
+    uint64_t bits;
+    std::memcpy(&bits, &d, sizeof bits);
+    return bits;
+}
+
+} // namespace
+
+EquityCache::EquityCache(size_t capacity, unsigned shards) {
+    layout(capacity, shards);
+    map(false);
+}
+
+EquityCache::EquityCache(const std::string& path, size_t capacity, unsigned shards) {
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ < 0) fail(path, std::strerror(errno));
+    struct stat st;
+    bool existing = false;
+    try {
+        if (::fstat(fd_, &st) != 0) fail(path, std::strerror(errno));
+        existing = st.st_size > 0;
+        if (existing) {
+            Header header;
+            if (::pread(fd_, &header, sizeof header, 0) != static_cast<ssize_t>(sizeof header) ||
+                std::memcmp(header.magic, kMagic, sizeof kMagic) != 0 ||
+                header.version != kVersion || !isPowerOfTwo(header.shardCount) ||
+                !isPowerOfTwo(header.slotsPerShard) ||
+                static_cast<uint64_t>(st.st_size) !=
+                    sizeof(Header) + sizeof(Slot) * header.shardCount * header.slotsPerShard) {
+                fail(path, "not an equity cache file");
+            }
+            shardCount_ = header.shardCount;
+            slotsPerShard_ = header.slotsPerShard;
+            bytes_ = static_cast<size_t>(st.st_size);
+        } else {
+            layout(capacity, shards);
+            if (::ftruncate(fd_, static_cast<off_t>(bytes_)) != 0) fail(path, std::strerror(errno));
+        }
+        map(existing);
+        if (!base_) fail(path, std::strerror(errno));
+    } catch (...) {
+        ::close(fd_);
+        throw;
+    }
+}
+
+EquityCache::~EquityCache() {
+    if (base_) ::munmap(base_, bytes_);
+    if (fd_ >= 0) ::close(fd_);
+}
+
+void EquityCache::layout(size_t capacity, unsigned shards) {
+    static_assert(sizeof(Header) == 64 && sizeof(Slot) == 64,
+                  "cache file layout is one 64-byte header plus 64-byte slots");
+    shardCount_ = static_cast<unsigned>(roundUpPowerOfTwo(shards ? shards : 1));
+    slotsPerShard_ = roundUpPowerOfTwo((capacity + shardCount_ - 1) / shardCount_);
+    if (slotsPerShard_ < kMaxProbe) slotsPerShard_ = kMaxProbe;
+    bytes_ = sizeof(Header) + sizeof(Slot) * shardCount_ * slotsPerShard_;
+}
+
+void EquityCache::map(bool existing) {
+    const int flags = fd_ >= 0 ? MAP_SHARED : MAP_PRIVATE | MAP_ANONYMOUS;
+    void* p = ::mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, flags, fd_, 0);
+    if (p == MAP_FAILED) {
+        if (fd_ < 0) throw std::bad_alloc();
+        return;
+    }
+    base_ = p;
+    shards_ = std::make_unique<Shard[]>(shardCount_);
+    if (existing) {
+        for (unsigned s = 0; s < shardCount_; ++s) {
+            const Slot* slots = shardSlots(s);
+            for (size_t i = 0; i < slotsPerShard_; ++i) shards_[s].used += slots[i].keyLo != 0;
+        }
+        return;
+    }
+    Header* header = static_cast<Header*>(base_);
+    std::memcpy(header->magic, kMagic, sizeof kMagic);
+    header->version = kVersion;
+    header->shardCount = shardCount_;
+    header->slotsPerShard = slotsPerShard_;
+}
+
+EquityCache::Slot* EquityCache::shardSlots(unsigned shard) const {
+    Slot* slots = reinterpret_cast<Slot*>(static_cast<char*>(base_) + sizeof(Header));
+    return slots + shard * slotsPerShard_;
+}
+
+bool EquityCache::lookup(const SpotKey& key, EquityResult& out) const {
+    const unsigned s = static_cast<unsigned>(key.hi & (shardCount_ - 1));
+    const Slot* slots = shardSlots(s);
+    const size_t mask = slotsPerShard_ - 1;
+    const size_t home = static_cast<size_t>(key.lo >> 1) & mask;
+    Shard& shard = shards_[s];
+    std::lock_guard<std::mutex> guard(shard.lock);
+    for (size_t i = 0; i < kMaxProbe; ++i) {
+        const Slot& slot = slots[(home + i) & mask];
+        if (slot.keyLo == 0) break;
+        if (slot.keyLo == key.lo && slot.keyHi == key.hi) {
+            out.trials = slot.trials;
+            out.win = slot.win;
+            out.tie = slot.tie;
+            out.loss = slot.loss;
+            out.equity = slot.equity;
+            out.stdError = slot.stdError;
+            ++shard.hits;
+            return true;
+        }
+    }
+    ++shard.misses;
+    return false;
+}
+
+void EquityCache::insert(const SpotKey& key, const EquityResult& result) {
+    const unsigned s = static_cast<unsigned>(key.hi & (shardCount_ - 1));
+    Slot* slots = shardSlots(s);
+    const size_t mask = slotsPerShard_ - 1;
+    const size_t home = static_cast<size_t>(key.lo >> 1) & mask;
+    Shard& shard = shards_[s];
+    std::lock_guard<std::mutex> guard(shard.lock);
+    Slot* target = &slots[home];  // evicted when every probed slot is taken
+    for (size_t i = 0; i < kMaxProbe; ++i) {
+        Slot& slot = slots[(home + i) & mask];
+        if (slot.keyLo == 0) {
+            ++shard.used;
+            target = &slot;
+            break;
+        }
+        if (slot.keyLo == key.lo && slot.keyHi == key.hi) {
+            target = &slot;
+            break;
+        }
+    }
+    // Empty the slot, fill in the result, then publish the key. The signal
+    // fences keep the compiler from reordering the stores, so a process
+    // killed part way through leaves the slot empty rather than showing the
+    // new key beside the evicted entry's result.
+    target->keyLo = 0;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    target->trials = result.trials;
+    target->win = result.win;
+    target->tie = result.tie;
+    target->loss = result.loss;
+    target->equity = result.equity;
+    target->stdError = result.stdError;
+    target->keyHi = key.hi;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    target->keyLo = key.lo;
+}
+
+bool EquityCache::flush() {
+    return fd_ < 0 || ::msync(base_, bytes_, MS_SYNC) == 0;
+}
+
+bool EquityCache::save(const std::string& path) const {
+    const std::string temp = path + ".tmp";
+    const int fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    bool ok = writeAll(fd, base_, sizeof(Header));
+    for (unsigned s = 0; ok && s < shardCount_; ++s) {
+        std::lock_guard<std::mutex> guard(shards_[s].lock);
+        ok = writeAll(fd, shardSlots(s), sizeof(Slot) * slotsPerShard_);
+    }
+    ok = ::fsync(fd) == 0 && ok;
+    ok = ::close(fd) == 0 && ok;
+    if (ok && ::rename(temp.c_str(), path.c_str()) == 0) return true;
+    ::unlink(temp.c_str());
+    return false;
+}
+
+size_t EquityCache::size() const {
+    size_t total = 0;
+    for (unsigned s = 0; s < shardCount_; ++s) {
+        std::lock_guard<std::mutex> guard(shards_[s].lock);
+        total += shards_[s].used;
+    }
+    return total;
+}
+
+uint64_t EquityCache::hits() const {
+    uint64_t total = 0;
+    for (unsigned s = 0; s < shardCount_; ++s) {
+        std::lock_guard<std::mutex> guard(shards_[s].lock);
+        total += shards_[s].hits;
+    }
+    return total;
+}
+
+uint64_t EquityCache::misses() const {
+    uint64_t total = 0;
+    for (unsigned s = 0; s < shardCount_; ++s) {
+        std::lock_guard<std::mutex> guard(shards_[s].lock);
+        total += shards_[s].misses;
+    }
+    return total;
+}
+
+EquityResult cachedExactEquity(EquityCache& cache, const Range& hero,
+                               const std::vector<Range>& villains, CardSet board,
+                               const ExactOptions& options) {
+    constexpr uint64_t kExactSalt = 0x6578616374000001ull;
+    const SpotKey key = canonicalSpotKey(hero, villains, board, options.dead, kExactSalt);
+    EquityResult result;
+    if (cache.lookup(key, result)) return result;
+    result = exactEquity(hero, villains, board, options);
+    cache.insert(key, result);
+    return result;
+}
+
+EquityResult cachedMonteCarloEquity(EquityCache& cache, const Range& hero,
+                                    const std::vector<Range>& villains, CardSet board,
+                                    const MonteCarloOptions& options) {
+    uint64_t state = 0x6d6f6e7465000001ull;
+    uint64_t salt = 0;
+    for (uint64_t field : {options.maxTrials, doubleBits(options.targetHalfWidth),
+                           doubleBits(options.confidenceZ), options.minTrials}) {
+        state ^= field;
+        salt = (salt << 1 | salt >> 63) ^ splitMix64(state);
+    }
+    const SpotKey key = canonicalSpotKey(hero, villains, board, options.dead, salt);
+    EquityResult result;
+    if (cache.lookup(key, result)) return result;
+    result = monteCarloEquity(hero, villains, board, options);
+    cache.insert(key, result);
+    return result;
+}
+
+} // namespace poker
@@ -0,0 +1,321 @@
+#include "poker/evaluator.hpp"
+
+#include "poker/profile.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <vector>
+
+namespace poker {
+
+namespace {
+
+// Per-rank keys whose sums are distinct for every multiset of up to seven ranks
+// with at most four copies of each rank.
+constexpr uint32_t kRankKeys[kNumRanks] = {
+    0, 1, 5, 22, 98, 453, 2031, 8698, 22854, 83661, 262349, 636345, 1479181,
+};
+
+constexpr uint32_t kHashMultipliers[] = {
+    0x9e3779b9u, 0x85ebca6bu, 0xc2b2ae35u, 0x27d4eb2fu, 0x165667b1u, 0xd3a2646du,
+};
+
+// What the table builder needs from a ranking policy.
+struct RankingSpec {
+    int lowestRank;
+    uint8_t strength[kNumHandCategories];  // position of each category in the order
+    const uint16_t* classes;               // per position
+    int values;
+};
+
+template <class Ranking>
+RankingSpec makeSpec() {
+    RankingSpec spec{Ranking::kLowestRank, {}, Ranking::kClasses, numHandValues<Ranking>()};
+    for (int i = 0; i < kNumHandCategories; ++i) {
+        spec.strength[static_cast<int>(Ranking::kOrder[i])] = static_cast<uint8_t>(i);
+    }
+    return spec;
+}
+
+// Raw scores order hands like the dense values do but are sparse: the
+// category's strength sits above five 4-bit rank slots, most significant rank
+// first.
+using RawScore = uint32_t;
+
+constexpr int kRawCategoryShift = 20;
+
+RawScore makeRaw(const RankingSpec& spec, HandCategory category, std::initializer_list<int> ranks) {
+    RawScore raw = spec.strength[static_cast<int>(category)];
+    int slots = 0;
+    for (int r : ranks) {
+        raw = (raw << 4) | static_cast<RawScore>(r);
+        ++slots;
+    }
+    for (; slots < 5; ++slots) raw <<= 4;
+    return raw;
+}
+
+// Highest straight contained in a rank mask as the rank of its top card, or
+// -1. The wheel is the ace below the four lowest ranks in the deck.
+int straightHigh(const RankingSpec& spec, unsigned mask) {
+    for (int high = kAce; high >= spec.lowestRank + 4; --high) {
+        const unsigned run = 0x1Fu << (high - 4);
+        if ((mask & run) == run) return high;
+    }
+    const unsigned wheel = (1u << kAce) | (0xFu << spec.lowestRank);
+    return (mask & wheel) == wheel ? spec.lowestRank + 3 : -1;
+}
+
+// Collects up to `n` ranks from `mask`, highest first; returns how many.
+int topRanks(unsigned mask, int n, int* out) {
+    int found = 0;
+    for (int r = kAce; r >= 0 && found < n; --r) {
+        if (mask & (1u << r)) out[found++] = r;
+    }
+    return found;
+}
+
+RawScore bestFlushRaw(const RankingSpec& spec, unsigned mask) {
+    const int high = straightHigh(spec, mask);
+    if (high >= 0) return makeRaw(spec, HandCategory::StraightFlush, {high});
+    int r[5];
+    topRanks(mask, 5, r);
+    return makeRaw(spec, HandCategory::Flush, {r[0], r[1], r[2], r[3], r[4]});
+}
+
+// Best non-flush five-card hand for a rank multiset of 5..7 cards.
+RawScore bestRankRaw(const RankingSpec& spec, const int (&counts)[kNumRanks]) {
+    unsigned present = 0, pairs = 0, trips = 0, quads = 0;
+    for (int r = 0; r < kNumRanks; ++r) {
+        if (counts[r] >= 1) present |= 1u << r;
+        if (counts[r] >= 2) pairs |= 1u << r;
+        if (counts[r] >= 3) trips |= 1u << r;
+        if (counts[r] >= 4) quads |= 1u << r;
+    }
+    int top[5] = {};
+    if (quads) {
+        topRanks(quads, 1, top);
+        const int quad = top[0];
+        topRanks(present & ~(1u << quad), 1, top);
+        return makeRaw(spec, HandCategory::FourOfAKind, {quad, top[0]});
+    }
+    if (trips) {
+        topRanks(trips, 1, top);
+        const int trip = top[0];
+        if (pairs & ~(1u << trip)) {
+            topRanks(pairs & ~(1u << trip), 1, top);
+            return makeRaw(spec, HandCategory::FullHouse, {trip, top[0]});
+        }
+    }
+    const int high = straightHigh(spec, present);
+    if (high >= 0) return makeRaw(spec, HandCategory::Straight, {high});
+    if (trips) {
+        topRanks(trips, 1, top);
+        const int trip = top[0];
+        topRanks(present & ~(1u << trip), 2, top);
+        return makeRaw(spec, HandCategory::ThreeOfAKind, {trip, top[0], top[1]});
+    }
+    if (pairs) {
+        int p[2];
+        if (topRanks(pairs, 2, p) == 2) {
+            topRanks(present & ~(1u << p[0]) & ~(1u << p[1]), 1, top);
+            return makeRaw(spec, HandCategory::TwoPair, {p[0], p[1], top[0]});
+        }
+        topRanks(present & ~(1u << p[0]), 3, top);
+        return makeRaw(spec, HandCategory::OnePair, {p[0], top[0], top[1], top[2]});
+    }
+    topRanks(present, 5, top);
+    return makeRaw(spec, HandCategory::HighCard, {top[0], top[1], top[2], top[3], top[4]});
+}
+
+struct RankEntry {
+    uint32_t key;
+    RawScore raw;
+};
+
+// Every multiset of 5..7 ranks from the ranking's deck, with its best hand.
+void collectRankMultisets(const RankingSpec& spec, int rank, int remaining, int (&counts)[kNumRanks],
+                          std::vector<RankEntry>& out) {
+    if (rank == kNumRanks) {
+        int total = 0;
+        uint32_t key = 0;
+        for (int r = 0; r < kNumRanks; ++r) {
+            total += counts[r];
+            key += static_cast<uint32_t>(counts[r]) * (kRankKeys[r] + detail::kCardCountUnit);
+        }
+        if (total >= 5) out.push_back({key, bestRankRaw(spec, counts)});
+        return;
+    }
+    const int most = rank < spec.lowestRank ? 0 : std::min(4, remaining);
+    for (int c = 0; c <= most; ++c) {
+        counts[rank] = c;
+        collectRankMultisets(spec, rank + 1, remaining - c, counts, out);
+    }
+    counts[rank] = 0;
+}
+
+bool buildPerfectHash(detail::EvalTables& t, const std::vector<RankEntry>& entries,
+                      const std::vector<RawScore>& classes, uint32_t multiplier) {
+    using detail::kRankHashBucketBits;
+    using detail::kRankHashBuckets;
+    using detail::kRankHashSlots;
+
+    std::vector<std::vector<uint32_t>> buckets(kRankHashBuckets);
+    for (uint32_t i = 0; i < entries.size(); ++i) {
+        const uint32_t h = detail::mixRankKey(entries[i].key, multiplier);
+        buckets[h >> (32 - kRankHashBucketBits)].push_back(i);
+    }
+    std::vector<uint32_t> order(kRankHashBuckets);
+    for (uint32_t b = 0; b < kRankHashBuckets; ++b) order[b] = b;
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return buckets[a].size() > buckets[b].size();
+    });
+
+    std::vector<uint8_t> used(kRankHashSlots, 0);
+    std::vector<uint32_t> slots;
+    for (uint32_t b : order) {
+        const std::vector<uint32_t>& members = buckets[b];
+        if (members.empty()) break;
+        uint32_t d = 0;
+        for (; d < kRankHashSlots; ++d) {
+            slots.clear();
+            bool ok = true;
+            for (uint32_t i : members) {
+                const uint32_t h = detail::mixRankKey(entries[i].key, multiplier);
+                const uint32_t slot = (h ^ d) & (kRankHashSlots - 1);
+                if (used[slot] || std::find(slots.begin(), slots.end(), slot) != slots.end()) {
+                    ok = false;
+                    break;
+                }
+                slots.push_back(slot);
+            }
+            if (ok) break;
+        }
+        if (d == kRankHashSlots) return false;
+        t.displacement[b] = d;
+        for (size_t k = 0; k < members.size(); ++k) {
+            used[slots[k]] = 1;
+            const RawScore raw = entries[members[k]].raw;
+            const auto it = std::lower_bound(classes.begin(), classes.end(), raw);
+            t.rankValue[slots[k]] = static_cast<HandValue>(it - classes.begin() + 1);
+        }
+    }
+    t.hashMultiplier = multiplier;
+    return true;
+}
+
+void fillTables(const RankingSpec& spec, detail::EvalTables& t) {
+    std::memset(&t, 0, sizeof(t));
+    for (unsigned mask = 0; mask < (1u << kNumRanks); ++mask) {
+        for (int r = 0; r < kNumRanks; ++r) {
+            if (mask & (1u << r)) t.suitKey[mask] += kRankKeys[r] + detail::kCardCountUnit;
+        }
+    }
+
+    std::vector<RankEntry> entries;
+    int counts[kNumRanks] = {};
+    collectRankMultisets(spec, 0, 7, counts, entries);
+
+    // The equivalence classes are exactly the distinct five-card hands.
+    std::vector<RawScore> classes;
+    for (const RankEntry& e : entries) {
+        if (e.key / detail::kCardCountUnit == 5) classes.push_back(e.raw);
+    }
+    // Flush masks are limited to the ranks in the deck; others never occur.
+    const unsigned deckRanks = kAllRanksMask & ~((1u << spec.lowestRank) - 1);
+    for (unsigned mask = 0; mask < (1u << kNumRanks); ++mask) {
+        if (__builtin_popcount(mask) == 5 && (mask & ~deckRanks) == 0) {
+            classes.push_back(bestFlushRaw(spec, mask));
+        }
+    }
+    std::sort(classes.begin(), classes.end());
+    classes.erase(std::unique(classes.begin(), classes.end()), classes.end());
+    if (classes.size() != static_cast<size_t>(spec.values)) std::abort();
+    int perCategory[kNumHandCategories] = {};
+    for (RawScore raw : classes) ++perCategory[raw >> kRawCategoryShift];
+    for (int i = 0; i < kNumHandCategories; ++i) {
+        if (perCategory[i] != spec.classes[i]) std::abort();
+    }
+
+    for (unsigned mask = 0; mask < (1u << kNumRanks); ++mask) {
+        if (__builtin_popcount(mask) < 5 || (mask & ~deckRanks) != 0) continue;
+        const RawScore raw = bestFlushRaw(spec, mask);
+        const auto it = std::lower_bound(classes.begin(), classes.end(), raw);
+        t.flushValue[mask] = static_cast<HandValue>(it - classes.begin() + 1);
+    }
+
+    for (uint32_t multiplier : kHashMultipliers) {
+        std::memset(t.displacement, 0, sizeof(t.displacement));
+        std::memset(t.rankValue, 0, sizeof(t.rankValue));
+        if (buildPerfectHash(t, entries, classes, multiplier)) return;
+    }
+    std::abort();
+}
+
+} // namespace
+
+const char* categoryName(HandCategory category) {
+    switch (category) {
+    case HandCategory::HighCard: return "High Card";
+    case HandCategory::OnePair: return "One Pair";
+    case HandCategory::TwoPair: return "Two Pair";
+    case HandCategory::ThreeOfAKind: return "Three of a Kind";
+    case HandCategory::Straight: return "Straight";
+    case HandCategory::Flush: return "Flush";
+    case HandCategory::FullHouse: return "Full House";
+    case HandCategory::FourOfAKind: return "Four of a Kind";
+    case HandCategory::StraightFlush: return "Straight Flush";
+    }
+    return "Unknown";
+}
+
+namespace detail {
+
+#if defined(POKER_HAVE_AVX2)
+// Defined in evaluator_avx2.cpp, which is built with -mavx2. Handles a
+// multiple of eight hands.
+void evaluateBatchAvx2(const EvalTables& t, const CardSet* hands, HandValue* out, size_t count);
+#endif
+
+template <class Ranking>
+const EvalTables& buildEvalTables() {
+    static EvalTables tables;
+    fillTables(makeSpec<Ranking>(), tables);
+    return tables;
+}
+
+template const EvalTables& buildEvalTables<StandardRanking>();
+template const EvalTables& buildEvalTables<ShortDeckRanking>();
+
+} // namespace detail
+
+bool batchEvaluatorUsesAvx2() {
+#if defined(POKER_HAVE_AVX2)
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+template <class Ranking>
+void evaluateBatch(const CardSet* hands, HandValue* out, size_t count) {
+    POKER_PROFILE_SCOPE(EvaluateBatch);
+    POKER_PROFILE_COUNT(HandsEvaluated, count);
+    size_t done = 0;
+#if defined(POKER_HAVE_AVX2)
+    // Every ranking shares the table layout, so one kernel serves them all.
+    if (batchEvaluatorUsesAvx2()) {
+        done = count & ~size_t{7};
+        detail::evaluateBatchAvx2(detail::evalTables<Ranking>(), hands, out, done);
+    }
+#endif
+    for (size_t i = done; i < count; ++i) out[i] = evaluate<Ranking>(hands[i]);
+}
+
+template void evaluateBatch<StandardRanking>(const CardSet*, HandValue*, size_t);
+template void evaluateBatch<ShortDeckRanking>(const CardSet*, HandValue*, size_t);
+
+} // namespace poker
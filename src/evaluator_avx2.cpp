@@ -0,0 +1,77 @@
+// AVX2 kernel for evaluateBatch(). This is the only translation unit compiled
+// with -mavx2; evaluator.cpp calls it only after checking the CPU.
+
+#include "poker/evaluator.hpp"
+
+#include <immintrin.h>
+
+namespace poker {
+namespace detail {
+
+namespace {
+
+// Loads a 16-bit table entry per lane. The tables carry a spare trailing entry,
+// so the 32-bit gather never reads past their end.
+inline __m256i gather16(const HandValue* table, __m256i index) {
+    const __m256i raw =
+        _mm256_i32gather_epi32(reinterpret_cast<const int*>(table), index, sizeof(HandValue));
+    return _mm256_and_si256(raw, _mm256_set1_epi32(0xFFFF));
+}
+
+inline __m256i gather32(const uint32_t* table, __m256i index) {
+    return _mm256_i32gather_epi32(reinterpret_cast<const int*>(table), index, sizeof(uint32_t));
+}
+
+} // namespace
+
+void evaluateBatchAvx2(const EvalTables& t, const CardSet* hands, HandValue* out, size_t count) {
+    static_assert(sizeof(CardSet) == sizeof(uint64_t), "CardSet must be a bare 64-bit mask");
+    const __m256i laneMask = _mm256_set1_epi32(kAllRanksMask);
+    const __m256i splitHalves = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+    const __m256i multiplier = _mm256_set1_epi32(static_cast<int>(t.hashMultiplier));
+    const __m256i finalMultiplier = _mm256_set1_epi32(0x2c1b3c6d);
+    const __m256i slotMask = _mm256_set1_epi32(kRankHashSlots - 1);
+
+    for (size_t i = 0; i < count; i += 8) {
+        // Split eight 64-bit masks into their low and high 32-bit halves.
+        const __m256i a = _mm256_permutevar8x32_epi32(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hands + i)), splitHalves);
+        const __m256i b = _mm256_permutevar8x32_epi32(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hands + i + 4)), splitHalves);
+        const __m256i lo = _mm256_permute2x128_si256(a, b, 0x20);
+        const __m256i hi = _mm256_permute2x128_si256(a, b, 0x31);
+
+        // Suit lanes sit at bits 0, 13, 26 and 39 of the 64-bit mask.
+        const __m256i clubs = _mm256_and_si256(lo, laneMask);
+        const __m256i diamonds = _mm256_and_si256(_mm256_srli_epi32(lo, 13), laneMask);
+        const __m256i hearts = _mm256_and_si256(
+            _mm256_or_si256(_mm256_srli_epi32(lo, 26), _mm256_slli_epi32(hi, 6)), laneMask);
+        const __m256i spades = _mm256_and_si256(_mm256_srli_epi32(hi, 7), laneMask);
+
+        const __m256i flush = _mm256_or_si256(
+            _mm256_or_si256(gather16(t.flushValue, clubs), gather16(t.flushValue, diamonds)),
+            _mm256_or_si256(gather16(t.flushValue, hearts), gather16(t.flushValue, spades)));
+
+        const __m256i key = _mm256_add_epi32(
+            _mm256_add_epi32(gather32(t.suitKey, clubs), gather32(t.suitKey, diamonds)),
+            _mm256_add_epi32(gather32(t.suitKey, hearts), gather32(t.suitKey, spades)));
+
+        // Same hash as mixRankKey().
+        __m256i h = _mm256_mullo_epi32(key, multiplier);
+        h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 15));
+        h = _mm256_mullo_epi32(h, finalMultiplier);
+        const __m256i bucket = _mm256_srli_epi32(h, 32 - kRankHashBucketBits);
+        const __m256i slot =
+            _mm256_and_si256(_mm256_xor_si256(h, gather32(t.displacement, bucket)), slotMask);
+        const __m256i rank = gather16(t.rankValue, slot);
+
+        const __m256i isFlush = _mm256_cmpgt_epi32(flush, _mm256_setzero_si256());
+        const __m256i value = _mm256_blendv_epi8(rank, flush, isFlush);
+        const __m128i packed = _mm_packus_epi32(_mm256_castsi256_si128(value),
+                                                _mm256_extracti128_si256(value, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packed);
+    }
+}
+
+} // namespace detail
+} // namespace poker
@@ -0,0 +1,586 @@
+#include "poker/hand_history.hpp"
+
+#include "poker/profile.hpp"
+#include "poker/varint.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace poker {
+
+namespace {
+
+using detail::getVarint;
+using detail::putVarint;
+
+constexpr uint8_t kUnknownCard = 0xff;
+
+// Event types whose records carry a chip amount.
+constexpr bool hasAmount(EventType type) {
+    switch (type) {
+    case EventType::Fold:
+    case EventType::Check:
+    case EventType::DealFlop:
+    case EventType::DealTurn:
+    case EventType::DealRiver:
+    case EventType::Show:
+        return false;
+    default:
+        return true;
+    }
+}
+
+// Events logged while the hand is being settled carry the final street.
+constexpr bool isSettlement(EventType type) {
+    return type == EventType::ReturnUncalled || type == EventType::Show ||
+           type == EventType::WinPot;
+}
+
+// Dealer events are the only ones logged without a seat.
+constexpr bool isDeal(EventType type) {
+    return type == EventType::DealFlop || type == EventType::DealTurn ||
+           type == EventType::DealRiver;
+}
+
+constexpr int kNumEventTypes = static_cast<int>(EventType::WinPot) + 1;
+
+void putHole(uint8_t*& out, CardSet hole) {
+    if (hole.size() != 2) {
+        *out++ = kUnknownCard;
+        *out++ = kUnknownCard;
+        return;
+    }
+    for (Card card : hole) *out++ = card.id;
+}
+
+template <class Events>
+size_t encodeRecord(const HandHeader& h, const Events& events, size_t count, uint8_t* out) {
+    // Encode the body after room for the longest length prefix, then slide it
+    // down behind the actual prefix.
+    constexpr size_t kPrefixRoom = 3;
+    uint8_t* const body = out + kPrefixRoom;
+    uint8_t* p = body;
+    p = putVarint(p, h.handNumber);
+    p = putVarint(p, h.tableId);
+    *p++ = static_cast<uint8_t>(h.seats | static_cast<int>(h.finalStreet) << 4);
+    *p++ = static_cast<uint8_t>(h.button);
+    p = putVarint(p, static_cast<uint64_t>(h.smallBlind));
+    p = putVarint(p, static_cast<uint64_t>(h.bigBlind));
+    p = putVarint(p, static_cast<uint64_t>(h.ante));
+    *p++ = static_cast<uint8_t>(h.dealt);
+    *p++ = static_cast<uint8_t>(h.dealt >> 8);
+    for (int seat = 0; seat < kMaxSeats; ++seat) {
+        if (!(h.dealt & (1u << seat))) continue;
+        p = putVarint(p, static_cast<uint64_t>(h.startingStack[seat]));
+        putHole(p, h.hole[seat]);
+    }
+    *p++ = static_cast<uint8_t>(h.board.size());
+    for (Card card : h.board) *p++ = card.id;
+    p = putVarint(p, count);
+    for (const HandEvent& e : events) {
+        *p++ = static_cast<uint8_t>(static_cast<int>(e.type) << 4 | (e.seat + 1));
+        if (hasAmount(e.type)) p = putVarint(p, static_cast<uint64_t>(e.amount) << 1 | (e.allIn & 1));
+        if (e.type == EventType::WinPot) *p++ = e.pot;
+    }
+    const size_t bodySize = static_cast<size_t>(p - body);
+    uint8_t prefix[kPrefixRoom + 1];
+    const size_t prefixSize = static_cast<size_t>(putVarint(prefix, bodySize) - prefix);
+    std::memmove(out + prefixSize, body, bodySize);
+    std::memcpy(out, prefix, prefixSize);
+    return prefixSize + bodySize;
+}
+
+struct PointerRange {
+    const HandEvent* first;
+    const HandEvent* last;
+    const HandEvent* begin() const { return first; }
+    const HandEvent* end() const { return last; }
+};
+
+bool readCard(const uint8_t*& in, const uint8_t* end, Card& card) {
+    if (in >= end || *in >= kNumCards) return false;
+    card = Card(*in++);
+    return true;
+}
+
+const char* eventName(EventType type) {
+    static constexpr const char* kNames[kNumEventTypes] = {
+        "ante", "small-blind", "big-blind", "fold", "check", "call", "bet",
+        "raise", "flop", "turn", "river", "return", "show", "win"};
+    return kNames[static_cast<int>(type)];
+}
+
+const char* streetName(Street street) {
+    static constexpr const char* kNames[] = {"preflop", "flop", "turn", "river", "showdown"};
+    return kNames[static_cast<int>(street)];
+}
+
+[[noreturn]] void fail(const std::string& path, const char* what) {
+    throw std::runtime_error("hand history: " + path + ": " + what);
+}
+
+// Returns how many bytes reached the file; fewer than `size` on an error.
+size_t writeAll(int fd, const uint8_t* data, size_t size) {
+    size_t written = 0;
+    while (written < size) {
+        const ssize_t n = ::write(fd, data + written, size - written);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        written += static_cast<size_t>(n);
+    }
+    return written;
+}
+
+void fileHeader(uint8_t out[hand_history::kFileHeaderBytes]) {
+    std::memset(out, 0, hand_history::kFileHeaderBytes);
+    std::memcpy(out, hand_history::kMagic, sizeof hand_history::kMagic);
+    out[4] = hand_history::kVersion;
+}
+
+bool validFileHeader(const uint8_t* data) {
+    return std::memcmp(data, hand_history::kMagic, sizeof hand_history::kMagic) == 0 &&
+           data[4] == hand_history::kVersion;
+}
+
+} // namespace
+
+size_t hand_history::encode(const HandHeader& header, const HandEvent* events, size_t count,
+                            uint8_t* out) {
+    return encodeRecord(header, PointerRange{events, events + count}, count, out);
+}
+
+size_t hand_history::recordEnd(const uint8_t* file, size_t size, size_t offset) {
+    const uint8_t* p = file + offset;
+    const uint8_t* const end = file + size;
+    uint64_t length;
+    if (!getVarint(p, end, length) || length > static_cast<uint64_t>(end - p)) return 0;
+    return static_cast<size_t>(p - file) + static_cast<size_t>(length);
+}
+
+HandHeader handHeader(const Table& table, uint32_t tableId) {
+    const HandState& st = table.state();
+    const TableConfig& config = table.config();
+    HandHeader h;
+    h.handNumber = st.handNumber;
+    h.tableId = tableId;
+    h.seats = static_cast<uint8_t>(config.seats);
+    h.button = st.button;
+    h.finalStreet = st.street;
+    h.smallBlind = config.smallBlind;
+    h.bigBlind = config.bigBlind;
+    h.ante = config.ante;
+    for (int seat = 0; seat < config.seats; ++seat) {
+        const SeatState& s = st.seats[seat];
+        if (!s.inHand) continue;
+        h.dealt |= static_cast<uint16_t>(1u << seat);
+        h.startingStack[seat] = s.startingStack;
+        h.hole[seat] = s.hole;
+    }
+    h.board = st.board;
+    return h;
+}
+
+bool EventReader::next(HandEvent& event) {
+    if (remaining_ == 0 || data_ >= end_) return false;
+    const uint8_t tag = *data_++;
+    const int type = tag >> 4;
+    const int seat = (tag & 0x0f) - 1;
+    if (type >= kNumEventTypes || seat >= kMaxSeats) return false;
+    event.type = static_cast<EventType>(type);
+    if ((seat < 0) != isDeal(event.type)) return false;
+    event.seat = static_cast<int8_t>(seat);
+    event.amount = 0;
+    event.allIn = 0;
+    event.pot = 0;
+    if (hasAmount(event.type)) {
+        uint64_t value;
+        if (!getVarint(data_, end_, value)) return false;
+        event.amount = static_cast<Chips>(value >> 1);
+        event.allIn = static_cast<uint8_t>(value & 1);
+    }
+    if (event.type == EventType::WinPot) {
+        if (data_ >= end_) return false;
+        event.pot = *data_++;
+    }
+    if (event.type == EventType::DealFlop) street_ = Street::Flop;
+    if (event.type == EventType::DealTurn) street_ = Street::Turn;
+    if (event.type == EventType::DealRiver) street_ = Street::River;
+    event.street = isSettlement(event.type) ? finalStreet_ : street_;
+    --remaining_;
+    return true;
+}
+
+bool decodeHand(const uint8_t* data, size_t size, HandView& out) {
+    const uint8_t* p = data;
+    const uint8_t* end = data + size;
+    HandHeader& h = out.header;
+    h = HandHeader();
+    uint64_t value;
+    if (!getVarint(p, end, h.handNumber) || !getVarint(p, end, value)) return false;
+    if (value > UINT32_MAX) return false;
+    h.tableId = static_cast<uint32_t>(value);
+    if (end - p < 2) return false;
+    h.seats = *p & 0x0f;
+    const int street = *p++ >> 4;
+    h.button = static_cast<int8_t>(*p++);
+    if (h.seats > kMaxSeats || street > static_cast<int>(Street::Showdown)) return false;
+    h.finalStreet = static_cast<Street>(street);
+    uint64_t blinds[3];
+    for (uint64_t& b : blinds) {
+        if (!getVarint(p, end, b)) return false;
+    }
+    h.smallBlind = static_cast<Chips>(blinds[0]);
+    h.bigBlind = static_cast<Chips>(blinds[1]);
+    h.ante = static_cast<Chips>(blinds[2]);
+    if (end - p < 2) return false;
+    h.dealt = static_cast<uint16_t>(p[0] | p[1] << 8);
+    p += 2;
+    for (int seat = 0; seat < kMaxSeats; ++seat) {
+        if (!(h.dealt & (1u << seat))) continue;
+        if (!getVarint(p, end, value) || end - p < 2) return false;
+        h.startingStack[seat] = static_cast<Chips>(value);
+        if (p[0] == kUnknownCard && p[1] == kUnknownCard) {
+            p += 2;
+            continue;
+        }
+        Card a, b;
+        if (!readCard(p, end, a) || !readCard(p, end, b)) return false;
+        h.hole[seat] = CardSet(a) | CardSet(b);
+    }
+    if (p >= end || *p > 5) return false;
+    const int boardSize = *p++;
+    for (int i = 0; i < boardSize; ++i) {
+        Card card;
+        if (!readCard(p, end, card)) return false;
+        h.board.add(card);
+    }
+    if (!getVarint(p, end, value)) return false;
+    out.eventCount = static_cast<uint32_t>(value);
+    out.eventData = p;
+    out.end = end;
+    return true;
+}
+
+size_t decodeRecord(const uint8_t* file, size_t size, size_t offset, HandView& out) {
+    const uint8_t* p = file + offset;
+    const uint8_t* const end = file + size;
+    uint64_t length;
+    if (!getVarint(p, end, length) || length > static_cast<uint64_t>(end - p) ||
+        !decodeHand(p, static_cast<size_t>(length), out)) {
+        return 0;
+    }
+    return static_cast<size_t>(p - file) + static_cast<size_t>(length);
+}
+
+HandHistoryWriter::HandHistoryWriter(const std::string& path, size_t bufferBytes)
+    : buffer_(std::max(bufferBytes, hand_history::maxRecordBytes(256))) {
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (fd_ < 0) fail(path, std::strerror(errno));
+    struct stat st;
+    uint8_t header[hand_history::kFileHeaderBytes];
+    if (::fstat(fd_, &st) != 0) {
+        ::close(fd_);
+        fail(path, std::strerror(errno));
+    }
+    if (st.st_size == 0) {
+        fileHeader(header);
+        std::memcpy(buffer_.data(), header, sizeof header);
+        used_ = sizeof header;
+    } else if (::pread(fd_, header, sizeof header, 0) != static_cast<ssize_t>(sizeof header) ||
+               !validFileHeader(header)) {
+        ::close(fd_);
+        fail(path, "not a hand-history file");
+    }
+}
+
+HandHistoryWriter::~HandHistoryWriter() {
+    flush();
+    ::close(fd_);
+}
+
+bool HandHistoryWriter::reserve(size_t bytes) {
+    if (failed_) return false;
+    if (used_ + bytes <= buffer_.size()) return true;
+    if (!flush()) return false;
+    // Only a hand with an enormous log outgrows the buffer.
+    if (bytes > buffer_.size()) buffer_.resize(bytes);
+    return true;
+}
+
+bool HandHistoryWriter::append(const Table& table, uint32_t tableId) {
+    POKER_PROFILE_SCOPE(HistoryAppend);
+    const ArenaList<HandEvent>& events = table.events();
+    if (!reserve(hand_history::maxRecordBytes(events.size()))) return false;
+    const size_t bytes = encodeRecord(handHeader(table, tableId), events, events.size(), buffer_.data() + used_);
+    POKER_PROFILE_COUNT(HistoryBytes, bytes);
+    used_ += bytes;
+    ++hands_;
+    return true;
+}
+
+bool HandHistoryWriter::append(const HandHeader& header, const HandEvent* events, size_t count) {
+    POKER_PROFILE_SCOPE(HistoryAppend);
+    if (!reserve(hand_history::maxRecordBytes(count))) return false;
+    const size_t bytes = hand_history::encode(header, events, count, buffer_.data() + used_);
+    POKER_PROFILE_COUNT(HistoryBytes, bytes);
+    used_ += bytes;
+    ++hands_;
+    return true;
+}
+
+bool HandHistoryWriter::flush() {
+    if (failed_) return false;
+    if (used_ == 0) return true;
+    const size_t written = writeAll(fd_, buffer_.data(), used_);
+    bytes_ += written;
+    if (written < used_) {
+        // The file may now end inside a record. Writing the rest later would
+        // not repair it, and rewriting the buffer would duplicate the part
+        // already on disk, so the writer stops here.
+        failed_ = true;
+        used_ = 0;
+        return false;
+    }
+    used_ = 0;
+    return true;
+}
+
+HandHistoryReader::HandHistoryReader(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) fail(path, std::strerror(errno));
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(hand_history::kFileHeaderBytes)) {
+        ::close(fd);
+        fail(path, "not a hand-history file");
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) fail(path, std::strerror(errno));
+    data_ = static_cast<const uint8_t*>(p);
+    if (!validFileHeader(data_)) {
+        ::munmap(p, size_);
+        fail(path, "not a hand-history file");
+    }
+    ::madvise(p, size_, MADV_SEQUENTIAL);
+}
+
+HandHistoryReader::~HandHistoryReader() {
+    if (data_) ::munmap(const_cast<uint8_t*>(data_), size_);
+}
+
+void HandHistoryReader::Iterator::load() {
+    const size_t size = reader_->size_;
+    if (!at_ || at_ == reader_->data_ + size) {
+        at_ = nullptr;
+        return;
+    }
+    const size_t end = decodeRecord(reader_->data_, size, offset(), view_);
+    if (end == 0) {
+        reader_->corrupt_ = true;
+        at_ = nullptr;
+        return;
+    }
+    next_ = reader_->data_ + end;
+}
+
+std::string toText(const HandView& hand) {
+    const HandHeader& h = hand.header;
+    char line[160];
+    std::string text;
+    std::snprintf(line, sizeof line,
+                  "hand %llu table %u seats %d button %d blinds %lld/%lld ante %lld ends %s\n",
+                  static_cast<unsigned long long>(h.handNumber), h.tableId, h.seats, h.button,
+                  static_cast<long long>(h.smallBlind), static_cast<long long>(h.bigBlind),
+                  static_cast<long long>(h.ante), streetName(h.finalStreet));
+    text += line;
+    for (int seat = 0; seat < kMaxSeats; ++seat) {
+        if (!(h.dealt & (1u << seat))) continue;
+        std::snprintf(line, sizeof line, "seat %d %lld %s\n", seat,
+                      static_cast<long long>(h.startingStack[seat]),
+                      h.hole[seat].empty() ? "????" : toString(h.hole[seat]).c_str());
+        text += line;
+    }
+    text += "board " + (h.board.empty() ? std::string("-") : toString(h.board)) + "\n";
+    EventReader events = hand.events();
+    HandEvent e;
+    while (events.next(e)) {
+        if (e.seat < 0) {
+            text += "- ";
+        } else {
+            text += std::to_string(e.seat) + ' ';
+        }
+        text += eventName(e.type);
+        if (hasAmount(e.type)) text += ' ' + std::to_string(e.amount);
+        if (e.allIn) text += " allin";
+        if (e.type == EventType::WinPot) text += " pot " + std::to_string(e.pot);
+        text += '\n';
+    }
+    text += "end\n";
+    return text;
+}
+
+namespace {
+
+// Splits one line into whitespace-separated words.
+int splitWords(std::string_view line, std::string_view* words, int capacity) {
+    int count = 0;
+    size_t i = 0;
+    while (i < line.size() && count < capacity) {
+        while (i < line.size() && (line[i] == ' ' || line[i] == '\t' || line[i] == '\r')) ++i;
+        const size_t start = i;
+        while (i < line.size() && line[i] != ' ' && line[i] != '\t' && line[i] != '\r') ++i;
+        if (i > start) words[count++] = line.substr(start, i - start);
+    }
+    return count;
+}
+
+bool toNumber(std::string_view word, long long& value) {
+    if (word.empty()) return false;
+    char* end = nullptr;
+    const std::string copy(word);
+    value = std::strtoll(copy.c_str(), &end, 10);
+    return *end == '\0';
+}
+
+bool parseHandLine(const std::string_view* w, int n, HandHeader& h) {
+    long long v[7];
+    if (n != 14 || w[0] != "hand" || w[2] != "table" || w[4] != "seats" || w[6] != "button" ||
+        w[8] != "blinds" || w[10] != "ante" || w[12] != "ends") {
+        return false;
+    }
+    const size_t slash = w[9].find('/');
+    if (slash == std::string_view::npos || !toNumber(w[1], v[0]) || !toNumber(w[3], v[1]) ||
+        !toNumber(w[5], v[2]) || !toNumber(w[7], v[3]) || !toNumber(w[9].substr(0, slash), v[4]) ||
+        !toNumber(w[9].substr(slash + 1), v[5]) || !toNumber(w[11], v[6]) || v[1] < 0 ||
+        v[1] > UINT32_MAX || v[2] < 2 || v[2] > kMaxSeats) {
+        return false;
+    }
+    h = HandHeader();
+    h.handNumber = static_cast<uint64_t>(v[0]);
+    h.tableId = static_cast<uint32_t>(v[1]);
+    h.seats = static_cast<uint8_t>(v[2]);
+    h.button = static_cast<int8_t>(v[3]);
+    h.smallBlind = v[4];
+    h.bigBlind = v[5];
+    h.ante = v[6];
+    for (int s = 0; s <= static_cast<int>(Street::Showdown); ++s) {
+        if (w[13] == streetName(static_cast<Street>(s))) {
+            h.finalStreet = static_cast<Street>(s);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseEventLine(const std::string_view* w, int n, HandEvent& e) {
+    long long value = -1;
+    if (n < 2 || !(w[0] == "-" || (toNumber(w[0], value) && value >= 0)) || value >= kMaxSeats) {
+        return false;
+    }
+    e = HandEvent{0, static_cast<int8_t>(value), EventType::Fold, Street::Preflop, 0, 0};
+    int type = 0;
+    while (type < kNumEventTypes && w[1] != eventName(static_cast<EventType>(type))) ++type;
+    if (type == kNumEventTypes) return false;
+    e.type = static_cast<EventType>(type);
+    if ((e.seat < 0) != isDeal(e.type)) return false;
+    int i = 2;
+    if (hasAmount(e.type)) {
+        if (i >= n || !toNumber(w[i++], value) || value < 0) return false;
+        e.amount = value;
+    }
+    if (i < n && w[i] == "allin") {
+        e.allIn = 1;
+        ++i;
+    }
+    if (e.type == EventType::WinPot) {
+        if (i + 1 >= n || w[i] != "pot" || !toNumber(w[i + 1], value) || value < 0 ||
+            value >= kMaxSeats) {
+            return false;
+        }
+        e.pot = static_cast<uint8_t>(value);
+        i += 2;
+    }
+    return i == n;
+}
+
+} // namespace
+
+bool historyToText(const std::string& binaryPath, const std::string& textPath) {
+    try {
+        HandHistoryReader reader(binaryPath);
+        FILE* out = std::fopen(textPath.c_str(), "w");
+        if (!out) return false;
+        bool ok = true;
+        for (const HandView& hand : reader) {
+            const std::string text = toText(hand);
+            ok = ok && std::fwrite(text.data(), 1, text.size(), out) == text.size();
+        }
+        ok = std::fclose(out) == 0 && ok;
+        return ok && !reader.corrupt();
+    } catch (const std::runtime_error&) {
+        return false;
+    }
+}
+
+bool textToHistory(const std::string& textPath, const std::string& binaryPath) {
+    FILE* in = std::fopen(textPath.c_str(), "r");
+    if (!in) return false;
+    std::remove(binaryPath.c_str());
+    bool ok = true;
+    try {
+        HandHistoryWriter writer(binaryPath);
+        HandHeader header;
+        std::vector<HandEvent> events;
+        bool inHand = false;
+        char buffer[512];
+        while (ok && std::fgets(buffer, sizeof buffer, in)) {
+            std::string_view line(buffer);
+            if (!line.empty() && line.back() == '\n') line.remove_suffix(1);
+            std::string_view w[16];
+            const int n = splitWords(line, w, 16);
+            if (n == 0) continue;
+            if (!inHand) {
+                ok = parseHandLine(w, n, header);
+                inHand = true;
+                events.clear();
+            } else if (w[0] == "seat") {
+                long long seat, stack;
+                ok = n == 4 && toNumber(w[1], seat) && seat >= 0 && seat < kMaxSeats &&
+                     toNumber(w[2], stack);
+                if (ok) {
+                    header.dealt |= static_cast<uint16_t>(1u << seat);
+                    header.startingStack[seat] = stack;
+                    ok = w[3] == "????" || (parseCardSet(w[3], header.hole[seat]) &&
+                                            header.hole[seat].size() == 2);
+                }
+            } else if (w[0] == "board") {
+                ok = n == 2 && (w[1] == "-" || (parseCardSet(w[1], header.board) &&
+                                                header.board.size() <= 5));
+            } else if (w[0] == "end") {
+                ok = n == 1 && writer.append(header, events.data(), events.size());
+                inHand = false;
+            } else {
+                HandEvent e;
+                ok = parseEventLine(w, n, e);
+                events.push_back(e);
+            }
+        }
+        ok = ok && !inHand && writer.flush();
+    } catch (const std::runtime_error&) {
+        ok = false;
+    }
+    std::fclose(in);
+    return ok;
+}
+
+} // namespace poker
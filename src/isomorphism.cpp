@@ -0,0 +1,154 @@
+#include "poker/isomorphism.hpp"
+
+#include "poker/rng.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace poker {
+
+namespace {
+
+struct PermutationTables {
+    SuitPermutation perms[kNumSuitPermutations];
+    /// source[p][j] is the combo that permutation p moves to combo j, so a
+    /// permuted range can be read in target order without building it.
+    uint16_t source[kNumSuitPermutations][kNumCombos];
+
+    PermutationTables() {
+        uint8_t order[kNumSuits] = {kClubs, kDiamonds, kHearts, kSpades};
+        int p = 0;
+        do {
+            std::copy(order, order + kNumSuits, perms[p].to);
+            for (int i = 0; i < kNumCombos; ++i) {
+                const CardSet moved = perms[p].apply(comboCards(i));
+                const Card lo = moved.lowest();
+                const Card hi = (moved - CardSet(lo)).lowest();
+                source[p][comboIndex(lo, hi)] = static_cast<uint16_t>(i);
+            }
+            ++p;
+        } while (std::next_permutation(order, order + kNumSuits));
+    }
+};
+
+const PermutationTables& permutationTables() {
+    static const PermutationTables tables;
+    return tables;
+}
+
+// Two independent 64-bit multiply-xorshift streams; 128 bits keeps accidental
+// collisions out of reach for any realistic cache size.
+class Digest {
+public:
+    explicit Digest(uint64_t salt) : a_(salt ^ 0x243f6a8885a308d3ull), b_(~salt) {}
+
+    void add(uint64_t word) {
+        a_ = (a_ ^ word) * 0x9e3779b97f4a7c15ull;
+        a_ ^= a_ >> 32;
+        b_ = (b_ + word) * 0xff51afd7ed558ccdull;
+        b_ ^= b_ >> 29;
+    }
+
+    SpotKey finish() const {
+        uint64_t a = a_;
+        uint64_t b = b_ ^ 0x5851f42d4c957f2dull;
+        return {splitMix64(a), splitMix64(b) | 1};  // never the empty key
+    }
+
+private:
+    uint64_t a_;
+    uint64_t b_;
+};
+
+// Digest of `range` relabeled by permutation p.
+SpotKey rangeDigest(const Range& range, int p) {
+    const uint16_t* source = permutationTables().source[p];
+    const float* weights = range.weights();
+    Digest digest(0);
+    for (int j = 0; j < kNumCombos; j += 2) {
+        uint32_t w0, w1;
+        std::memcpy(&w0, &weights[source[j]], sizeof w0);
+        std::memcpy(&w1, &weights[source[j + 1]], sizeof w1);
+        digest.add(uint64_t{w0} | (uint64_t{w1} << 32));
+    }
+    return digest.finish();
+}
+
+bool keyLess(const SpotKey& a, const SpotKey& b) { return a.hi != b.hi ? a.hi < b.hi : a.lo < b.lo; }
+
+} // namespace
+
+Range SuitPermutation::apply(const Range& range) const {
+    const PermutationTables& tables = permutationTables();
+    int p = 0;
+    while (std::memcmp(tables.perms[p].to, to, sizeof to) != 0) ++p;
+    Range out;
+    for (int j = 0; j < kNumCombos; ++j) out.set(j, range.weight(tables.source[p][j]));
+    return out;
+}
+
+const SuitPermutation& suitPermutation(int index) { return permutationTables().perms[index]; }
+
+CardSet canonicalCards(CardSet cards, SuitPermutation* used) {
+    const PermutationTables& tables = permutationTables();
+    CardSet best = cards;
+    int bestIndex = 0;
+    for (int p = 1; p < kNumSuitPermutations; ++p) {
+        const CardSet moved = tables.perms[p].apply(cards);
+        if (moved.bits() < best.bits()) {
+            best = moved;
+            bestIndex = p;
+        }
+    }
+    if (used) *used = tables.perms[bestIndex];
+    return best;
+}
+
+SpotKey canonicalSpotKey(const Range& hero, const std::vector<Range>& villains, CardSet board,
+                         CardSet dead, uint64_t salt) {
+    const PermutationTables& tables = permutationTables();
+
+    // Relabelings that minimize (board, dead); isomorphic queries get
+    // corresponding candidate sets, so breaking ties by digest is canonical.
+    int candidates[kNumSuitPermutations];
+    int count = 0;
+    CardSet bestBoard, bestDead;
+    for (int p = 0; p < kNumSuitPermutations; ++p) {
+        const CardSet b = tables.perms[p].apply(board);
+        const CardSet d = tables.perms[p].apply(dead);
+        if (count == 0 || b.bits() < bestBoard.bits() ||
+            (b == bestBoard && d.bits() < bestDead.bits())) {
+            count = 0;
+            bestBoard = b;
+            bestDead = d;
+        } else if (b != bestBoard || d != bestDead) {
+            continue;
+        }
+        candidates[count++] = p;
+    }
+
+    std::vector<SpotKey> villainDigests(villains.size());
+    SpotKey best;
+    for (int c = 0; c < count; ++c) {
+        const int p = candidates[c];
+        for (size_t v = 0; v < villains.size(); ++v) villainDigests[v] = rangeDigest(villains[v], p);
+        std::sort(villainDigests.begin(), villainDigests.end(), keyLess);
+
+        Digest digest(salt);
+        digest.add(bestBoard.bits());
+        digest.add(bestDead.bits());
+        const SpotKey h = rangeDigest(hero, p);
+        digest.add(h.hi);
+        digest.add(h.lo);
+        digest.add(villainDigests.size());
+        for (const SpotKey& v : villainDigests) {
+            digest.add(v.hi);
+            digest.add(v.lo);
+        }
+        const SpotKey key = digest.finish();
+        if (c == 0 || keyLess(key, best)) best = key;
+    }
+    return best;
+}
+
+} // namespace poker
@@ -0,0 +1,202 @@
+#include "poker/kmeans.hpp"
+
+#include "poker/profile.hpp"
+#include "poker/rng.hpp"
+#include "poker/thread_pool.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace poker {
+
+namespace detail {
+
+#if defined(POKER_HAVE_AVX2)
+// Defined in kmeans_avx2.cpp, which is built with -mavx2.
+void nearestCentroidsAvx2(const float* points, size_t count, const float* centroids, int k,
+                          int stride, uint32_t* nearest, float* distance);
+#endif
+
+} // namespace detail
+
+namespace {
+
+// Points per assignment task. Fixed, so the merge order of partial sums does
+// not depend on the pool size.
+constexpr size_t kBlockPoints = 16384;
+
+float squaredDistance(const float* a, const float* b, int stride) {
+    float acc[kKMeansLanes] = {};
+    for (int d = 0; d < stride; d += kKMeansLanes) {
+        for (int l = 0; l < kKMeansLanes; ++l) {
+            const float diff = a[d + l] - b[d + l];
+            acc[l] += diff * diff;
+        }
+    }
+    float sum = 0;
+    for (float v : acc) sum += v;
+    return sum;
+}
+
+// k-means++: each further centroid is a sample point drawn with probability
+// proportional to its squared distance from the nearest chosen one.
+void seedCentroids(const float* points, size_t count, int stride, const KMeansOptions& options,
+                   float* centroids) {
+    Rng rng(options.seed);
+    const size_t sampleSize = std::min(count, std::max<size_t>(options.seedSample, options.clusters));
+    std::vector<size_t> sample(sampleSize);
+    for (size_t i = 0; i < sampleSize; ++i) {
+        sample[i] = sampleSize == count ? i : static_cast<size_t>(rng.uniform() * count);
+    }
+    std::vector<float> best(sampleSize, 3.4e38f);
+    size_t chosen = sample[rng.below(static_cast<uint32_t>(sampleSize))];
+    for (int c = 0; c < options.clusters; ++c) {
+        float* centroid = centroids + size_t(c) * stride;
+        std::copy_n(points + chosen * stride, stride, centroid);
+        double total = 0;
+        for (size_t i = 0; i < sampleSize; ++i) {
+            best[i] = std::min(best[i], squaredDistance(points + sample[i] * stride, centroid, stride));
+            total += best[i];
+        }
+        if (total <= 0) {
+            // Fewer distinct points than clusters in the sample; duplicates
+            // are harmless and are reseeded if they end up empty.
+            chosen = sample[rng.below(static_cast<uint32_t>(sampleSize))];
+            continue;
+        }
+        double target = rng.uniform() * total;
+        size_t pick = sampleSize - 1;
+        for (size_t i = 0; i < sampleSize; ++i) {
+            target -= best[i];
+            if (target < 0) {
+                pick = i;
+                break;
+            }
+        }
+        chosen = sample[pick];
+    }
+}
+
+} // namespace
+
+bool kMeansUsesAvx2() {
+#if defined(POKER_HAVE_AVX2)
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+void nearestCentroids(const float* points, size_t count, const float* centroids, int k,
+                      int stride, uint32_t* nearest, float* distance) {
+#if defined(POKER_HAVE_AVX2)
+    if (kMeansUsesAvx2()) {
+        detail::nearestCentroidsAvx2(points, count, centroids, k, stride, nearest, distance);
+        return;
+    }
+#endif
+    for (size_t i = 0; i < count; ++i) {
+        const float* p = points + i * stride;
+        float best = 3.4e38f;
+        uint32_t bestIndex = 0;
+        for (int c = 0; c < k; ++c) {
+            const float dist = squaredDistance(p, centroids + size_t(c) * stride, stride);
+            if (dist < best) {
+                best = dist;
+                bestIndex = static_cast<uint32_t>(c);
+            }
+        }
+        nearest[i] = bestIndex;
+        distance[i] = best;
+    }
+}
+
+KMeansResult kMeans(const float* points, size_t count, int stride, const KMeansOptions& options) {
+    const int k = options.clusters;
+    if (k < 1 || count < static_cast<size_t>(k)) {
+        throw std::invalid_argument("kMeans: need at least as many points as clusters");
+    }
+    if (stride <= 0 || stride % kKMeansLanes != 0) {
+        throw std::invalid_argument("kMeans: stride must be a positive multiple of kKMeansLanes");
+    }
+    ThreadPool& pool = options.pool ? *options.pool : ThreadPool::shared();
+
+    KMeansResult result;
+    result.stride = stride;
+    result.centroids.assign(size_t(k) * stride, 0.0f);
+    result.assignment.assign(count, ~uint32_t{0});
+    seedCentroids(points, count, stride, options, result.centroids.data());
+
+    const size_t blocks = (count + kBlockPoints - 1) / kBlockPoints;
+    const size_t blockFloats = size_t(k) * stride;
+    std::vector<double> sums(blocks * blockFloats);
+    std::vector<uint64_t> counts(blocks * size_t(k));
+    std::vector<double> inertia(blocks);
+    std::vector<size_t> changed(blocks);
+    std::vector<float> distance(count);
+
+    for (int iteration = 0; iteration < options.maxIterations; ++iteration) {
+        pool.parallelFor(blocks, [&](size_t block, unsigned) {
+            const size_t first = block * kBlockPoints;
+            const size_t n = std::min(kBlockPoints, count - first);
+            POKER_PROFILE_SCOPE(KMeansAssign);
+            POKER_PROFILE_COUNT(KMeansDistances, n * k);
+            std::vector<uint32_t> nearest(n);
+            nearestCentroids(points + first * stride, n, result.centroids.data(), k, stride,
+                             nearest.data(), distance.data() + first);
+            double* sum = sums.data() + block * blockFloats;
+            uint64_t* cnt = counts.data() + block * size_t(k);
+            std::fill_n(sum, blockFloats, 0.0);
+            std::fill_n(cnt, k, 0);
+            double err = 0;
+            size_t moved = 0;
+            for (size_t i = 0; i < n; ++i) {
+                const uint32_t c = nearest[i];
+                moved += result.assignment[first + i] != c;
+                result.assignment[first + i] = c;
+                const float* p = points + (first + i) * stride;
+                double* s = sum + size_t(c) * stride;
+                for (int d = 0; d < stride; ++d) s[d] += p[d];
+                ++cnt[c];
+                err += distance[first + i];
+            }
+            inertia[block] = err;
+            changed[block] = moved;
+        });
+
+        // Merge in block order so the sums are bit-identical for any pool.
+        std::vector<double> total(blockFloats, 0.0);
+        std::vector<uint64_t> members(k, 0);
+        result.inertia = 0;
+        size_t moved = 0;
+        for (size_t b = 0; b < blocks; ++b) {
+            const double* sum = sums.data() + b * blockFloats;
+            for (size_t j = 0; j < blockFloats; ++j) total[j] += sum[j];
+            for (int c = 0; c < k; ++c) members[c] += counts[b * k + c];
+            result.inertia += inertia[b];
+            moved += changed[b];
+        }
+        result.iterations = iteration + 1;
+        if (moved == 0) break;
+
+        for (int c = 0; c < k; ++c) {
+            float* centroid = result.centroids.data() + size_t(c) * stride;
+            if (members[c] > 0) {
+                for (int d = 0; d < stride; ++d) {
+                    centroid[d] = static_cast<float>(total[size_t(c) * stride + d] / members[c]);
+                }
+                continue;
+            }
+            // Empty cluster: move it onto the worst-served point, which then
+            // no longer counts as worst for the next empty cluster.
+            const size_t far = static_cast<size_t>(
+                std::max_element(distance.begin(), distance.end()) - distance.begin());
+            std::copy_n(points + far * stride, stride, centroid);
+            distance[far] = 0;
+        }
+    }
+    return result;
+}
+
+} // namespace poker
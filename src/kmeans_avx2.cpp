@@ -0,0 +1,39 @@
+// AVX2 nearest-centroid kernel for k-means. This translation unit is compiled
+// with -mavx2; kmeans.cpp calls it only after checking the CPU.
+
+#include "poker/kmeans.hpp"
+
+#include <immintrin.h>
+
+namespace poker {
+namespace detail {
+
+void nearestCentroidsAvx2(const float* points, size_t count, const float* centroids, int k,
+                          int stride, uint32_t* nearest, float* distance) {
+    for (size_t i = 0; i < count; ++i) {
+        const float* p = points + i * stride;
+        float best = 3.4e38f;
+        uint32_t bestIndex = 0;
+        for (int c = 0; c < k; ++c) {
+            const float* q = centroids + size_t(c) * stride;
+            __m256 acc = _mm256_setzero_ps();
+            for (int d = 0; d < stride; d += kKMeansLanes) {
+                const __m256 diff = _mm256_sub_ps(_mm256_loadu_ps(p + d), _mm256_loadu_ps(q + d));
+                acc = _mm256_add_ps(acc, _mm256_mul_ps(diff, diff));
+            }
+            // Horizontal sum of the eight lanes.
+            const __m128 half = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+            const __m128 pair = _mm_add_ps(half, _mm_movehl_ps(half, half));
+            const float dist = _mm_cvtss_f32(_mm_add_ss(pair, _mm_shuffle_ps(pair, pair, 1)));
+            if (dist < best) {
+                best = dist;
+                bestIndex = static_cast<uint32_t>(c);
+            }
+        }
+        nearest[i] = bestIndex;
+        distance[i] = best;
+    }
+}
+
+} // namespace detail
+} // namespace poker
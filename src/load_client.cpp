@@ -0,0 +1,315 @@
+#include "poker/load_client.hpp"
+
+#include "poker/protocol.hpp"
+#include "poker/rng.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace poker {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kMaxEvents = 256;
+constexpr size_t kInputBytes = 4096;
+constexpr size_t kOutputBytes = 256;
+
+struct Shared {
+    std::atomic<int> welcomed{0};
+    std::atomic<bool> measuring{false};
+    std::atomic<bool> stopping{false};
+};
+
+struct ClientConnection {
+    int fd = -1;
+    int seat = -1;
+    bool welcomed = false;
+    bool dirty = false;        ///< on the worker's flush list
+    bool awaiting = false;     ///< an Act is in flight
+    bool measured = false;     ///< it was sent inside the measurement window
+    Clock::time_point sentAt;
+    size_t inBegin = 0;
+    size_t inEnd = 0;
+    size_t outSize = 0;
+    uint8_t in[kInputBytes];
+    uint8_t out[kOutputBytes];
+};
+
+struct WorkerResult {
+    std::vector<uint32_t> latencies;   // nanoseconds
+    uint64_t actions = 0;
+    uint64_t hands = 0;
+    uint64_t errors = 0;
+    int connected = 0;
+};
+
+int connectTo(const sockaddr_in& addr) {
+    const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof addr) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    const int on = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof on);
+    ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return fd;
+}
+
+class Worker {
+public:
+    Worker(const LoadClientConfig& config, Shared& shared, unsigned index)
+        : config_(config), shared_(shared), rng_(Rng::forStream(config.seed, index)) {}
+
+    ~Worker() {
+        for (auto& c : connections_) {
+            if (c->fd >= 0) ::close(c->fd);
+        }
+        if (epollFd_ >= 0) ::close(epollFd_);
+    }
+
+    // Connects on the calling thread so failures surface before any
+    // traffic starts.
+    bool connect(const sockaddr_in& addr, int count) {
+        epollFd_ = ::epoll_create1(EPOLL_CLOEXEC);
+        if (epollFd_ < 0) return false;
+        for (int i = 0; i < count; ++i) {
+            auto c = std::make_unique<ClientConnection>();
+            c->fd = connectTo(addr);
+            if (c->fd < 0) return false;
+            epoll_event ev{};
+            ev.events = EPOLLIN | EPOLLRDHUP;
+            ev.data.ptr = c.get();
+            if (::epoll_ctl(epollFd_, EPOLL_CTL_ADD, c->fd, &ev) != 0) return false;
+            connections_.push_back(std::move(c));
+        }
+        result.connected = count;
+        return true;
+    }
+
+    void run() {
+        protocol::Message join;
+        join.type = protocol::MessageType::Join;
+        for (auto& c : connections_) send(*c, join);
+        flushAll();
+
+        epoll_event events[kMaxEvents];
+        while (!shared_.stopping.load(std::memory_order_relaxed)) {
+            const int n = ::epoll_wait(epollFd_, events, kMaxEvents, 10);
+            for (int i = 0; i < n; ++i) {
+                ClientConnection& c = *static_cast<ClientConnection*>(events[i].data.ptr);
+                if (c.fd >= 0) readAll(c);
+            }
+            flushAll();
+        }
+    }
+
+    WorkerResult result;
+
+private:
+    void readAll(ClientConnection& c) {
+        for (;;) {
+            if (c.inEnd == kInputBytes) {
+                std::memmove(c.in, c.in + c.inBegin, c.inEnd - c.inBegin);
+                c.inEnd -= c.inBegin;
+                c.inBegin = 0;
+            }
+            const ssize_t n = ::read(c.fd, c.in + c.inEnd, kInputBytes - c.inEnd);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && errno == EAGAIN) break;
+            if (n <= 0) {
+                drop(c);
+                return;
+            }
+            c.inEnd += static_cast<size_t>(n);
+            protocol::Message message;
+            for (;;) {
+                const long used = protocol::decode(c.in + c.inBegin, c.inEnd - c.inBegin, message);
+                if (used == 0) break;
+                if (used < 0) {
+                    drop(c);
+                    return;
+                }
+                c.inBegin += static_cast<size_t>(used);
+                handle(c, message);
+            }
+            if (c.inBegin == c.inEnd) c.inBegin = c.inEnd = 0;
+        }
+    }
+
+    void handle(ClientConnection& c, const protocol::Message& message) {
+        const bool measuring = shared_.measuring.load(std::memory_order_relaxed);
+        switch (message.type) {
+        case protocol::MessageType::Welcome:
+            c.seat = message.seat;
+            if (!c.welcomed) {
+                c.welcomed = true;
+                shared_.welcomed.fetch_add(1, std::memory_order_relaxed);
+            }
+            break;
+        case protocol::MessageType::ActionRequest: {
+            const LegalActions& legal = message.legal;
+            const double r = rng_.uniform();
+            protocol::Message reply;
+            reply.type = protocol::MessageType::Act;
+            if (r < config_.foldProbability && !legal.canCheck) {
+                reply.action = Action::fold();
+            } else if (r < config_.foldProbability + config_.raiseProbability && legal.canRaise) {
+                reply.action = Action::raiseTo(legal.minRaiseTo);
+            } else {
+                reply.action = legal.canCheck ? Action::check() : Action::call();
+            }
+            send(c, reply);
+            c.awaiting = true;
+            c.measured = measuring;
+            c.sentAt = Clock::now();
+            break;
+        }
+        case protocol::MessageType::Event: {
+            const EventType type = message.event.type;
+            if (!c.awaiting || message.event.seat != c.seat || type < EventType::Fold ||
+                type > EventType::Raise) {
+                break;
+            }
+            c.awaiting = false;
+            if (c.measured && measuring) {
+                const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - c.sentAt);
+                result.latencies.push_back(static_cast<uint32_t>(std::min<int64_t>(ns.count(), UINT32_MAX)));
+                ++result.actions;
+            }
+            break;
+        }
+        case protocol::MessageType::HandEnd:
+            if (measuring) ++result.hands;
+            break;
+        default:
+            break;
+        }
+    }
+
+    void send(ClientConnection& c, const protocol::Message& message) {
+        if (c.outSize + protocol::kMaxFrameBytes > kOutputBytes) flush(c);
+        c.outSize += protocol::encode(message, c.out + c.outSize);
+        if (!c.dirty) {
+            c.dirty = true;
+            dirty_.push_back(&c);
+        }
+    }
+
+    void flushAll() {
+        for (ClientConnection* c : dirty_) flush(*c);
+        dirty_.clear();
+    }
+
+    // Client messages are a few bytes and the socket buffer is nearly
+    // always empty, so a short write is treated as a lost connection.
+    void flush(ClientConnection& c) {
+        c.dirty = false;
+        if (c.fd < 0 || c.outSize == 0) return;
+        ssize_t n;
+        do n = ::send(c.fd, c.out, c.outSize, MSG_NOSIGNAL); while (n < 0 && errno == EINTR);
+        if (n != static_cast<ssize_t>(c.outSize)) {
+            drop(c);
+            return;
+        }
+        c.outSize = 0;
+    }
+
+    void drop(ClientConnection& c) {
+        if (c.fd < 0) return;
+        if (!shared_.stopping.load(std::memory_order_relaxed)) ++result.errors;
+        ::close(c.fd);
+        c.fd = -1;
+    }
+
+    const LoadClientConfig& config_;
+    Shared& shared_;
+    Rng rng_;
+    int epollFd_ = -1;
+    std::vector<std::unique_ptr<ClientConnection>> connections_;
+    std::vector<ClientConnection*> dirty_;
+};
+
+double percentile(std::vector<uint32_t>& values, double q) {
+    if (values.empty()) return 0;
+    const size_t index = std::min(values.size() - 1, static_cast<size_t>(q * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index] / 1000.0;
+}
+
+} // namespace
+
+LoadReport runLoadClient(const LoadClientConfig& config) {
+    if (config.connections < 1 || config.threads < 1) {
+        throw std::invalid_argument("runLoadClient: bad configuration");
+    }
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(config.port);
+    if (::inet_pton(AF_INET, config.address.c_str(), &addr.sin_addr) != 1) {
+        throw std::invalid_argument("runLoadClient: bad IPv4 address " + config.address);
+    }
+
+    Shared shared;
+    std::vector<std::unique_ptr<Worker>> workers;
+    for (unsigned t = 0; t < config.threads; ++t) {
+        const int count = config.connections / static_cast<int>(config.threads) +
+                          (static_cast<int>(t) < config.connections % static_cast<int>(config.threads));
+        workers.push_back(std::make_unique<Worker>(config, shared, t));
+        if (!workers.back()->connect(addr, count)) {
+            throw std::runtime_error(std::string("runLoadClient: connect: ") + std::strerror(errno));
+        }
+    }
+    std::vector<std::thread> threads;
+    for (auto& worker : workers) threads.emplace_back([&worker] { worker->run(); });
+
+    // Measure only once every player is seated, so table start-up is not
+    // counted; give up waiting after ten seconds.
+    const auto deadline = Clock::now() + std::chrono::seconds(10);
+    while (shared.welcomed.load() < config.connections && Clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    const auto start = Clock::now();
+    shared.measuring = true;
+    std::this_thread::sleep_for(std::chrono::duration<double>(config.seconds));
+    shared.measuring = false;
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    shared.stopping = true;
+    for (std::thread& t : threads) t.join();
+
+    LoadReport report;
+    report.seconds = seconds;
+    std::vector<uint32_t> latencies;
+    for (auto& worker : workers) {
+        const WorkerResult& r = worker->result;
+        report.connected += r.connected;
+        report.actions += r.actions;
+        report.hands += r.hands;
+        report.errors += r.errors;
+        latencies.insert(latencies.end(), r.latencies.begin(), r.latencies.end());
+    }
+    report.p50Micros = percentile(latencies, 0.50);
+    report.p99Micros = percentile(latencies, 0.99);
+    report.p999Micros = percentile(latencies, 0.999);
+    report.maxMicros = latencies.empty() ? 0 : *std::max_element(latencies.begin(), latencies.end()) / 1000.0;
+    return report;
+}
+
+} // namespace poker
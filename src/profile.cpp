@@ -0,0 +1,124 @@
+#include "poker/profile.hpp"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace poker {
+namespace profile {
+
+namespace {
+
+constexpr const char* kPhaseNames[kNumPhases] = {
+    "evaluate_batch", "equity_monte_carlo", "equity_exact", "table_start_hand",
+    "table_act",      "simulation_shard",   "history_append", "cfr_iterate",
+    "cfr_traverse",   "kmeans_assign",      "abstraction_features", "server_batch",
+};
+
+constexpr const char* kCounterNames[kNumCounters] = {
+    "hands_evaluated", "equity_trials", "hands_dealt", "actions",
+    "history_bytes",   "cfr_iterations", "kmeans_distances", "server_messages",
+};
+
+#if defined(POKER_PROFILE)
+
+// One thread's totals. Only the owning thread writes, so updates are plain
+// load/store pairs; atomics only make the concurrent reads in report() legal.
+struct alignas(64) Slots {
+    std::atomic<uint64_t> calls[kNumPhases] = {};
+    std::atomic<uint64_t> nanoseconds[kNumPhases] = {};
+    std::atomic<uint64_t> counters[kNumCounters] = {};
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Slots>> slots;
+};
+
+Registry& registry() {
+    static Registry* r = new Registry;  // never destroyed: threads may outlive statics
+    return *r;
+}
+
+Slots& localSlots() {
+    thread_local Slots* slots = [] {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> guard(r.mutex);
+        r.slots.push_back(std::make_unique<Slots>());
+        return r.slots.back().get();
+    }();
+    return *slots;
+}
+
+void bump(std::atomic<uint64_t>& value, uint64_t amount) {
+    value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+#endif
+
+} // namespace
+
+const char* name(Phase phase) { return kPhaseNames[static_cast<int>(phase)]; }
+const char* name(Counter counter) { return kCounterNames[static_cast<int>(counter)]; }
+
+#if defined(POKER_PROFILE)
+
+bool enabled() { return true; }
+
+void record(Phase phase, uint64_t nanoseconds) {
+    Slots& s = localSlots();
+    bump(s.calls[static_cast<int>(phase)], 1);
+    bump(s.nanoseconds[static_cast<int>(phase)], nanoseconds);
+}
+
+void add(Counter counter, uint64_t amount) { bump(localSlots().counters[static_cast<int>(counter)], amount); }
+
+void reset() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> guard(r.mutex);
+    for (auto& s : r.slots) {
+        for (auto& v : s->calls) v.store(0, std::memory_order_relaxed);
+        for (auto& v : s->nanoseconds) v.store(0, std::memory_order_relaxed);
+        for (auto& v : s->counters) v.store(0, std::memory_order_relaxed);
+    }
+}
+
+void report(FILE* out) {
+    uint64_t calls[kNumPhases] = {};
+    uint64_t nanoseconds[kNumPhases] = {};
+    uint64_t counters[kNumCounters] = {};
+    {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> guard(r.mutex);
+        for (auto& s : r.slots) {
+            for (int i = 0; i < kNumPhases; ++i) {
+                calls[i] += s->calls[i].load(std::memory_order_relaxed);
+                nanoseconds[i] += s->nanoseconds[i].load(std::memory_order_relaxed);
+            }
+            for (int i = 0; i < kNumCounters; ++i) counters[i] += s->counters[i].load(std::memory_order_relaxed);
+        }
+    }
+    for (int i = 0; i < kNumPhases; ++i) {
+        if (calls[i] == 0) continue;
+        std::fprintf(out, "profile=%s calls=%llu seconds=%.6f ns_per_call=%.1f\n", kPhaseNames[i],
+                     static_cast<unsigned long long>(calls[i]), nanoseconds[i] * 1e-9,
+                     double(nanoseconds[i]) / calls[i]);
+    }
+    for (int i = 0; i < kNumCounters; ++i) {
+        if (counters[i] == 0) continue;
+        std::fprintf(out, "counter=%s value=%llu\n", kCounterNames[i],
+                     static_cast<unsigned long long>(counters[i]));
+    }
+}
+
+#else
+
+bool enabled() { return false; }
+void reset() {}
+void report(FILE*) {}
+
+#endif
+
+} // namespace profile
+} // namespace poker
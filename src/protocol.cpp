@@ -0,0 +1,165 @@
+#include "poker/protocol.hpp"
+
+#include "poker/varint.hpp"
+
+namespace poker {
+namespace protocol {
+
+namespace {
+
+using detail::getVarint;
+using detail::putVarint;
+using detail::unZigZag;
+using detail::zigZag;
+
+constexpr int kNumEventTypes = static_cast<int>(EventType::WinPot) + 1;
+
+bool getByte(const uint8_t*& in, const uint8_t* end, uint8_t& value) {
+    if (in == end) return false;
+    value = *in++;
+    return true;
+}
+
+bool getChips(const uint8_t*& in, const uint8_t* end, Chips& value) {
+    uint64_t raw;
+    if (!getVarint(in, end, raw)) return false;
+    value = static_cast<Chips>(raw);
+    return value >= 0;
+}
+
+bool getCards(const uint8_t*& in, const uint8_t* end, CardSet& cards) {
+    uint64_t bits;
+    if (!getVarint(in, end, bits) || (bits & ~kFullDeckBits)) return false;
+    cards = CardSet(bits);
+    return true;
+}
+
+bool decodeBody(const uint8_t* in, const uint8_t* end, Message& m) {
+    uint8_t type;
+    if (!getByte(in, end, type)) return false;
+    m.type = static_cast<MessageType>(type);
+    uint64_t value;
+    uint8_t byte;
+    switch (m.type) {
+    case MessageType::Join:
+    case MessageType::Leave:
+        break;
+    case MessageType::Act:
+        if (!getByte(in, end, byte) || byte > Action::Raise) return false;
+        m.action.type = static_cast<Action::Type>(byte);
+        m.action.amount = 0;
+        if ((m.action.type == Action::Bet || m.action.type == Action::Raise) &&
+            !getChips(in, end, m.action.amount)) {
+            return false;
+        }
+        break;
+    case MessageType::Welcome:
+        if (!getVarint(in, end, value) || value > UINT32_MAX || !getByte(in, end, m.seat)) return false;
+        m.table = static_cast<uint32_t>(value);
+        break;
+    case MessageType::HandStart: {
+        uint8_t a, b;
+        if (!getVarint(in, end, m.handNumber) || !getByte(in, end, m.seat) ||
+            !getByte(in, end, a) || !getByte(in, end, b) || a >= kNumCards || b >= kNumCards) {
+            return false;
+        }
+        m.cards = CardSet(Card(a)) | Card(b);
+        break;
+    }
+    case MessageType::ActionRequest:
+        if (!getByte(in, end, byte) || !getChips(in, end, m.legal.toCall) ||
+            !getChips(in, end, m.legal.minRaiseTo) || !getChips(in, end, m.legal.maxRaiseTo) ||
+            !getCards(in, end, m.cards)) {
+            return false;
+        }
+        m.legal.canCheck = byte & 1;
+        m.legal.canRaise = byte & 2;
+        break;
+    case MessageType::Event: {
+        if (!getByte(in, end, byte) || (byte >> 4) >= kNumEventTypes) return false;
+        HandEvent& e = m.event;
+        e = HandEvent{};
+        e.type = static_cast<EventType>(byte >> 4);
+        e.seat = static_cast<int8_t>((byte & 0xf) - 1);
+        if (!getVarint(in, end, value)) return false;
+        e.amount = static_cast<Chips>(value >> 1);
+        e.allIn = value & 1;
+        if (e.type == EventType::WinPot && !getByte(in, end, e.pot)) return false;
+        break;
+    }
+    case MessageType::HandEnd:
+        if (!getVarint(in, end, m.handNumber) || !getVarint(in, end, value) ||
+            !getCards(in, end, m.cards)) {
+            return false;
+        }
+        m.amount = unZigZag(value);
+        break;
+    default:
+        return false;
+    }
+    return in == end;
+}
+
+} // namespace
+
+size_t encode(const Message& m, uint8_t* out) {
+    uint8_t* p = out + kFrameHeaderBytes;
+    *p++ = static_cast<uint8_t>(m.type);
+    switch (m.type) {
+    case MessageType::Join:
+    case MessageType::Leave:
+        break;
+    case MessageType::Act:
+        *p++ = m.action.type;
+        if (m.action.type == Action::Bet || m.action.type == Action::Raise) {
+            p = putVarint(p, static_cast<uint64_t>(m.action.amount));
+        }
+        break;
+    case MessageType::Welcome:
+        p = putVarint(p, m.table);
+        *p++ = m.seat;
+        break;
+    case MessageType::HandStart: {
+        p = putVarint(p, m.handNumber);
+        *p++ = m.seat;
+        CardSet hole = m.cards;
+        *p++ = hole.popLowest().id;
+        *p++ = hole.popLowest().id;
+        break;
+    }
+    case MessageType::ActionRequest:
+        *p++ = static_cast<uint8_t>(m.legal.canCheck | m.legal.canRaise << 1);
+        p = putVarint(p, static_cast<uint64_t>(m.legal.toCall));
+        p = putVarint(p, static_cast<uint64_t>(m.legal.minRaiseTo));
+        p = putVarint(p, static_cast<uint64_t>(m.legal.maxRaiseTo));
+        p = putVarint(p, m.cards.bits());
+        break;
+    case MessageType::Event:
+        *p++ = static_cast<uint8_t>(static_cast<int>(m.event.type) << 4 | (m.event.seat + 1));
+        p = putVarint(p, static_cast<uint64_t>(m.event.amount) << 1 | (m.event.allIn & 1));
+        if (m.event.type == EventType::WinPot) *p++ = m.event.pot;
+        break;
+    case MessageType::HandEnd:
+        p = putVarint(p, m.handNumber);
+        p = putVarint(p, zigZag(m.amount));
+        p = putVarint(p, m.cards.bits());
+        break;
+    }
+    const size_t body = static_cast<size_t>(p - out) - kFrameHeaderBytes;
+    out[0] = static_cast<uint8_t>(body);
+    out[1] = static_cast<uint8_t>(body >> 8);
+    return static_cast<size_t>(p - out);
+}
+
+long decode(const uint8_t* data, size_t size, Message& out) {
+    if (size < kFrameHeaderBytes) return 0;
+    const size_t body = data[0] | size_t{data[1]} << 8;
+    if (body == 0 || body > kMaxFrameBytes - kFrameHeaderBytes) return -1;
+    if (size < kFrameHeaderBytes + body) return 0;
+    const uint8_t* begin = data + kFrameHeaderBytes;
+    if (!decodeBody(begin, begin + body, out)) return -1;
+    return static_cast<long>(kFrameHeaderBytes + body);
+}
+
+} // namespace protocol
+} // namespace poker
@@ -0,0 +1,200 @@
+#include "poker/range.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+namespace poker {
+
+namespace {
+
+int indexOf(CardSet hand) {
+    const Card lo = hand.lowest();
+    const Card hi = (hand - CardSet(lo)).lowest();
+    return comboIndex(lo, hi);
+}
+
+enum class Kind { Pair, Suited, Offsuit, Any };
+
+// A hand class such as "AKs" or "99", high rank first.
+struct HandClass {
+    int high;
+    int low;
+    Kind kind;
+};
+
+bool parseClass(std::string_view text, HandClass& out) {
+    if (text.size() < 2 || text.size() > 3) return false;
+    int a = parseRank(text[0]);
+    int b = parseRank(text[1]);
+    if (a < 0 || b < 0) return false;
+    if (a < b) std::swap(a, b);
+    Kind kind = a == b ? Kind::Pair : Kind::Any;
+    if (text.size() == 3) {
+        if (kind == Kind::Pair) return false;
+        if (text[2] == 's') kind = Kind::Suited;
+        else if (text[2] == 'o') kind = Kind::Offsuit;
+        else return false;
+    }
+    out = {a, b, kind};
+    return true;
+}
+
+void setClass(Range& range, int high, int low, Kind kind, float weight) {
+    for (int s1 = 0; s1 < kNumSuits; ++s1) {
+        for (int s2 = 0; s2 < kNumSuits; ++s2) {
+            const bool suited = s1 == s2;
+            if (kind == Kind::Pair ? s2 <= s1
+                                   : (kind == Kind::Suited && !suited) ||
+                                         (kind == Kind::Offsuit && suited)) {
+                continue;
+            }
+            range.set(comboIndex(Card(high, s1), Card(low, s2)), weight);
+        }
+    }
+}
+
+// One entry without its weight suffix.
+bool applyEntry(std::string_view body, float weight, Range& range) {
+    CardSet hand;
+    if (body.size() == 4 && parseCardSet(body, hand)) {
+        if (hand.size() != 2) return false;
+        range.set(indexOf(hand), weight);
+        return true;
+    }
+
+    HandClass first;
+    if (body.back() == '+') {
+        if (!parseClass(body.substr(0, body.size() - 1), first)) return false;
+        if (first.kind == Kind::Pair) {
+            for (int r = first.low; r < kNumRanks; ++r) setClass(range, r, r, Kind::Pair, weight);
+        } else {
+            for (int k = first.low; k < first.high; ++k) setClass(range, first.high, k, first.kind, weight);
+        }
+        return true;
+    }
+
+    const size_t dash = body.find('-');
+    if (dash == std::string_view::npos) {
+        if (!parseClass(body, first)) return false;
+        setClass(range, first.high, first.low, first.kind, weight);
+        return true;
+    }
+    HandClass last;
+    if (!parseClass(body.substr(0, dash), first) || !parseClass(body.substr(dash + 1), last) ||
+        first.kind != last.kind) {
+        return false;
+    }
+    if (first.kind == Kind::Pair) {
+        const int from = std::min(first.low, last.low);
+        const int to = std::max(first.low, last.low);
+        for (int r = from; r <= to; ++r) setClass(range, r, r, Kind::Pair, weight);
+        return true;
+    }
+    if (first.high != last.high) return false;
+    const int from = std::min(first.low, last.low);
+    const int to = std::max(first.low, last.low);
+    for (int k = from; k <= to; ++k) setClass(range, first.high, k, first.kind, weight);
+    return true;
+}
+
+bool isSeparator(char c) { return c == ',' || c == ' ' || c == '\t' || c == '\n'; }
+
+} // namespace
+
+void Range::set(CardSet hand, float weight) {
+    if (hand.size() != 2) throw std::invalid_argument("Range::set: hand must be two cards");
+    set(indexOf(hand), weight);
+}
+
+float Range::weight(CardSet hand) const {
+    return hand.size() == 2 ? weights_[indexOf(hand)] : 0.0f;
+}
+
+void Range::removeBlocked(CardSet dead, float* out) const {
+    // Branch-free so the compiler can vectorize the mask test and select.
+    const detail::ComboMasks& masks = detail::kComboMasks;
+    const uint32_t deadLow = static_cast<uint32_t>(dead.bits());
+    const uint32_t deadHigh = static_cast<uint32_t>(dead.bits() >> 32);
+    for (int i = 0; i < kNumCombos; ++i) {
+        const float weight = weights_[i];
+        const uint32_t blocked = (masks.low[i] & deadLow) | (masks.high[i] & deadHigh);
+        out[i] = blocked == 0 ? weight : 0.0f;
+    }
+}
+
+std::vector<Range::Combo> Range::combos(CardSet dead) const {
+    alignas(64) float live[kNumCombos];
+    removeBlocked(dead, live);
+    std::vector<Combo> out;
+    for (int i = 0; i < kNumCombos; ++i) {
+        if (live[i] > 0.0f) out.push_back({comboCards(i), live[i]});
+    }
+    return out;
+}
+
+int Range::size() const {
+    int count = 0;
+    for (int i = 0; i < kNumCombos; ++i) count += weights_[i] > 0.0f;
+    return count;
+}
+
+double Range::totalWeight() const {
+    double total = 0;
+    for (int i = 0; i < kNumCombos; ++i) total += weights_[i];
+    return total;
+}
+
+bool parseRange(std::string_view text, Range& out) {
+    Range range;
+    size_t i = 0;
+    while (i < text.size()) {
+        if (isSeparator(text[i])) {
+            ++i;
+            continue;
+        }
+        size_t end = i;
+        while (end < text.size() && !isSeparator(text[end])) ++end;
+        std::string_view entry = text.substr(i, end - i);
+        i = end;
+
+        float weight = 1.0f;
+        const size_t colon = entry.find(':');
+        if (colon != std::string_view::npos) {
+            const char* first = entry.data() + colon + 1;
+            const char* last = entry.data() + entry.size();
+            const auto [ptr, ec] = std::from_chars(first, last, weight);
+            if (ec != std::errc() || ptr != last || !std::isfinite(weight) || weight < 0.0f) {
+                return false;
+            }
+            entry = entry.substr(0, colon);
+        }
+        if (entry.empty() || !applyEntry(entry, weight, range)) return false;
+    }
+    out = range;
+    return true;
+}
+
+std::string toString(const Range& range) {
+    std::string text;
+    char weight[32];
+    for (int i = 0; i < kNumCombos; ++i) {
+        const float w = range.weight(i);
+        if (w <= 0.0f) continue;
+        if (!text.empty()) text += ',';
+        const CardSet cards = comboCards(i);
+        const Card low = cards.lowest();
+        text += toString((cards - CardSet(low)).lowest());
+        text += toString(low);
+        if (w != 1.0f) {
+            const auto result = std::to_chars(weight, weight + sizeof weight, w);
+            text += ':';
+            text.append(weight, result.ptr);
+        }
+    }
+    return text;
+}
+
+} // namespace poker
@@ -0,0 +1,643 @@
+#include "poker/server.hpp"
+
+#include "poker/buffer_pool.hpp"
+#include "poker/profile.hpp"
+#include "poker/protocol.hpp"
+#include "poker/rng.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace poker {
+
+namespace {
+
+constexpr int kMaxEvents = 256;
+constexpr int kMaxIovecs = 16;
+// How often a loop looks for expired action deadlines.
+constexpr int64_t kDeadlineSweepMs = 100;
+
+// epoll_event::data.ptr values that are not connections.
+char listenTag;
+char wakeTag;
+
+[[noreturn]] void fail(const char* what) {
+    throw std::runtime_error(std::string("GameServer: ") + what + ": " + std::strerror(errno));
+}
+
+int listenSocket(const std::string& address, uint16_t port) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (::inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1) {
+        throw std::invalid_argument("GameServer: bad IPv4 address " + address);
+    }
+    const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) fail("socket");
+    const int on = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof on);
+    if (::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof on) != 0 ||
+        ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) != 0 ||
+        ::listen(fd, SOMAXCONN) != 0) {
+        const int error = errno;
+        ::close(fd);
+        errno = error;
+        fail("bind");
+    }
+    return fd;
+}
+
+uint16_t boundPort(int fd) {
+    sockaddr_in addr{};
+    socklen_t length = sizeof addr;
+    if (::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &length) != 0) fail("getsockname");
+    return ntohs(addr.sin_port);
+}
+
+struct Connection {
+    int fd = -1;
+    PooledBuffer* in = nullptr;
+    PooledBuffer* outHead = nullptr;
+    PooledBuffer* outTail = nullptr;
+    size_t queued = 0;
+    int table = -1;
+    int seat = -1;
+    bool dirty = false;        ///< on the loop's flush list
+    bool writeArmed = false;   ///< registered for EPOLLOUT
+    bool doomed = false;       ///< output overflowed; closed after the batch
+    bool closed = false;
+};
+
+struct ServerTable {
+    std::unique_ptr<Table> table;
+    Connection* players[kMaxSeats] = {};
+    Rng rng;
+    uint32_t id = 0;
+    size_t eventsSent = 0;
+    int waitingSeat = -1;      ///< seat holding an unanswered ActionRequest
+    int64_t deadline = 0;      ///< when waitingSeat is acted for, in nowMs() time
+    bool dealing = false;      ///< a hand started and its HandEnd is not sent
+};
+
+int64_t nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+} // namespace
+
+class GameServer::Loop {
+public:
+    Loop(const ServerConfig& config, int listenFd, unsigned index)
+        : config_(config), index_(index), listenFd_(listenFd), pool_(config.bufferBytes) {
+        epollFd_ = ::epoll_create1(EPOLL_CLOEXEC);
+        wakeFd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        try {
+            if (epollFd_ < 0 || wakeFd_ < 0) fail("epoll");
+            watch(listenFd_, &listenTag);
+            watch(wakeFd_, &wakeTag);
+        } catch (...) {
+            // The destructor does not run; the caller closes listenFd.
+            if (wakeFd_ >= 0) ::close(wakeFd_);
+            if (epollFd_ >= 0) ::close(epollFd_);
+            throw;
+        }
+    }
+
+    ~Loop() {
+        if (thread_.joinable()) stop();
+        for (auto& c : connections_) {
+            if (!c->closed) ::close(c->fd);
+        }
+        ::close(listenFd_);
+        if (wakeFd_ >= 0) ::close(wakeFd_);
+        if (epollFd_ >= 0) ::close(epollFd_);
+    }
+
+    void start() { thread_ = std::thread([this] { run(); }); }
+
+    void stop() {
+        const uint64_t one = 1;
+        [[maybe_unused]] const ssize_t n = ::write(wakeFd_, &one, sizeof one);
+        thread_.join();
+    }
+
+    ServerStats stats;
+
+private:
+    void watch(int fd, void* tag) {
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.ptr = tag;
+        if (::epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &ev) != 0) fail("epoll_ctl");
+    }
+
+    void run() {
+        epoll_event events[kMaxEvents];
+        bool stopping = false;
+        while (!stopping) {
+            const int n = ::epoll_wait(epollFd_, events, kMaxEvents, waitTimeout());
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            POKER_PROFILE_SCOPE(ServerBatch);
+            for (int i = 0; i < n; ++i) {
+                void* tag = events[i].data.ptr;
+                if (tag == &listenTag) {
+                    acceptAll();
+                } else if (tag == &wakeTag) {
+                    stopping = true;
+                } else {
+                    Connection& c = *static_cast<Connection*>(tag);
+                    if (c.closed) continue;
+                    if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLERR | EPOLLHUP)) readAll(c);
+                    if (!c.closed && (events[i].events & EPOLLOUT)) flush(c);
+                }
+            }
+            expireDeadlines();
+            endBatch();
+        }
+        for (auto& c : connections_) {
+            if (c->closed) continue;
+            c->closed = true;
+            ::close(c->fd);
+            ++stats.disconnected;
+        }
+        stats.buffers = pool_.allocated();
+    }
+
+    // epoll_wait() timeout: until the next deadline sweep, or forever when
+    // actions never time out.
+    int waitTimeout() const {
+        if (config_.actionTimeoutMs == 0) return -1;
+        return static_cast<int>(std::max<int64_t>(nextSweep_ - nowMs(), 0));
+    }
+
+    // Acts for players whose ActionRequest has expired, as the disconnect
+    // path does. Tables are swept every kDeadlineSweepMs rather than kept in
+    // deadline order, which costs one pass over this loop's tables per sweep
+    // and no bookkeeping per action.
+    void expireDeadlines() {
+        if (config_.actionTimeoutMs == 0) return;
+        const int64_t now = nowMs();
+        if (now < nextSweep_) return;
+        nextSweep_ = now + kDeadlineSweepMs;
+        for (const auto& entry : tables_) {
+            ServerTable& t = *entry;
+            if (t.waitingSeat < 0 || t.deadline > now) continue;
+            Table& table = *t.table;
+            table.act(table.legalActions().canCheck ? Action::check() : Action::fold());
+            ++stats.timeouts;
+            t.waitingSeat = -1;
+            drive(t);
+        }
+    }
+
+    // Replies queued while handling the batch go out here, one sendmsg() per
+    // connection. Closing a connection can make its table act for it and
+    // queue more output, so repeat until nothing is left.
+    void endBatch() {
+        while (!doomed_.empty() || !dirty_.empty()) {
+            while (!doomed_.empty()) {
+                Connection* c = doomed_.back();
+                doomed_.pop_back();
+                close(*c);
+            }
+            for (size_t i = 0; i < dirty_.size(); ++i) flush(*dirty_[i]);
+            dirty_.clear();
+        }
+        for (Connection* c : closed_) {
+            *c = Connection();
+            free_.push_back(c);
+        }
+        closed_.clear();
+    }
+
+    void acceptAll() {
+        for (;;) {
+            const int fd = ::accept4(listenFd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) return;  // EAGAIN, or out of descriptors: retried on the next wakeup
+            const int on = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof on);
+            Connection* c;
+            if (free_.empty()) {
+                connections_.push_back(std::make_unique<Connection>());
+                c = connections_.back().get();
+            } else {
+                c = free_.back();
+                free_.pop_back();
+            }
+            c->fd = fd;
+            epoll_event ev{};
+            ev.events = EPOLLIN | EPOLLRDHUP;
+            ev.data.ptr = c;
+            if (::epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &ev) != 0) {
+                ::close(fd);
+                c->closed = true;
+                closed_.push_back(c);
+                continue;
+            }
+            ++stats.accepted;
+        }
+    }
+
+    void readAll(Connection& c) {
+        const size_t capacity = pool_.bufferBytes();
+        for (;;) {
+            if (!c.in) c.in = pool_.acquire();
+            PooledBuffer& b = *c.in;
+            if (b.end == capacity) {
+                std::memmove(b.data(), b.data() + b.begin, b.size());
+                b.end -= b.begin;
+                b.begin = 0;
+            }
+            const size_t space = capacity - b.end;
+            const ssize_t n = ::read(c.fd, b.data() + b.end, space);
+            if (n == 0 || (n < 0 && errno != EINTR && errno != EAGAIN)) {
+                close(c);
+                return;
+            }
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            b.end += static_cast<uint32_t>(n);
+            stats.bytesIn += static_cast<uint64_t>(n);
+            if (!parse(c)) return;
+            if (static_cast<size_t>(n) < space) break;
+        }
+        if (c.in && c.in->size() == 0) {
+            pool_.release(c.in);
+            c.in = nullptr;
+        }
+    }
+
+    // Handles every whole frame in the input buffer. Returns false if the
+    // connection was closed.
+    bool parse(Connection& c) {
+        PooledBuffer& b = *c.in;
+        protocol::Message message;
+        for (;;) {
+            const long n = protocol::decode(b.data() + b.begin, b.size(), message);
+            if (n == 0) break;
+            if (n < 0) {
+                close(c);
+                return false;
+            }
+            b.begin += static_cast<uint32_t>(n);
+            ++stats.messagesIn;
+            POKER_PROFILE_COUNT(ServerMessages, 1);
+            handle(c, message);
+            if (c.closed) return false;
+        }
+        if (b.begin == b.end) b.begin = b.end = 0;
+        return true;
+    }
+
+    void handle(Connection& c, const protocol::Message& message) {
+        switch (message.type) {
+        case protocol::MessageType::Join:
+            if (c.table < 0) join(c);
+            break;
+        case protocol::MessageType::Act:
+            act(c, message.action);
+            break;
+        case protocol::MessageType::Leave:
+            close(c);
+            break;
+        default:
+            close(c);  // a server-to-client message
+            break;
+        }
+    }
+
+    void join(Connection& c) {
+        const int seats = config_.table.seats;
+        for (size_t t = 0; t < tables_.size() && c.table < 0; ++t) {
+            ServerTable& table = *tables_[t];
+            for (int s = 0; s < seats; ++s) {
+                if (!table.players[s] && !table.table->state().seats[s].occupied) {
+                    c.table = static_cast<int>(t);
+                    c.seat = s;
+                    break;
+                }
+            }
+        }
+        if (c.table < 0) {
+            auto table = std::make_unique<ServerTable>();
+            table->table = std::make_unique<Table>(config_.table);
+            table->id = static_cast<uint32_t>(index_ + tables_.size() * config_.threads);
+            table->rng = Rng::forStream(config_.seed, table->id);
+            c.table = static_cast<int>(tables_.size());
+            c.seat = 0;
+            tables_.push_back(std::move(table));
+            ++stats.tables;
+        }
+        ServerTable& table = *tables_[c.table];
+        table.players[c.seat] = &c;
+        protocol::Message welcome;
+        welcome.type = protocol::MessageType::Welcome;
+        welcome.table = table.id;
+        welcome.seat = static_cast<uint8_t>(c.seat);
+        send(c, welcome);
+        drive(table);
+    }
+
+    void act(Connection& c, Action action) {
+        if (c.table < 0) {
+            ++stats.illegalActions;
+            return;
+        }
+        ServerTable& t = *tables_[c.table];
+        Table& table = *t.table;
+        if (t.waitingSeat != c.seat || table.toAct() != c.seat) {
+            ++stats.illegalActions;  // not this player's turn
+            return;
+        }
+        const LegalActions legal = table.legalActions();
+        if (!legal.allows(action)) {
+            ++stats.illegalActions;
+            action = legal.canCheck ? Action::check() : Action::fold();
+        }
+        table.act(action);
+        ++stats.actions;
+        t.waitingSeat = -1;
+        drive(t);
+    }
+
+    // Runs a table until it needs input from a connected player: relays new
+    // log entries, acts for seats whose player left, settles finished hands,
+    // reseats and deals the next one.
+    void drive(ServerTable& t) {
+        Table& table = *t.table;
+        const int seats = config_.table.seats;
+        for (;;) {
+            relayEvents(t);
+            if (table.handInProgress()) {
+                const int seat = table.toAct();
+                Connection* player = t.players[seat];
+                if (player) {
+                    if (t.waitingSeat != seat) {
+                        t.waitingSeat = seat;
+                        protocol::Message request;
+                        request.type = protocol::MessageType::ActionRequest;
+                        request.legal = table.legalActions();
+                        request.cards = table.state().board;
+                        send(*player, request);
+                        if (config_.actionTimeoutMs > 0) t.deadline = nowMs() + config_.actionTimeoutMs;
+                    }
+                    return;
+                }
+                table.act(table.legalActions().canCheck ? Action::check() : Action::fold());
+                ++stats.autoFolds;
+                continue;
+            }
+
+            const HandState& state = table.state();
+            if (t.dealing) {
+                t.dealing = false;
+                protocol::Message end;
+                end.type = protocol::MessageType::HandEnd;
+                end.handNumber = state.handNumber;
+                end.cards = state.board;
+                for (int s = 0; s < seats; ++s) {
+                    if (!t.players[s] || !state.seats[s].inHand) continue;
+                    end.amount = state.seats[s].stack - state.seats[s].startingStack;
+                    send(*t.players[s], end);
+                }
+            }
+            for (int s = 0; s < seats; ++s) {
+                if (t.players[s]) {
+                    table.seatPlayer(s, config_.stack);
+                } else if (state.seats[s].occupied) {
+                    table.removePlayer(s);
+                }
+            }
+            if (!table.startHand(t.rng)) return;
+            ++stats.hands;
+            t.dealing = true;
+            t.eventsSent = 0;
+            t.waitingSeat = -1;
+            protocol::Message start;
+            start.type = protocol::MessageType::HandStart;
+            start.handNumber = state.handNumber;
+            start.seat = static_cast<uint8_t>(state.button);
+            for (int s = 0; s < seats; ++s) {
+                if (!t.players[s] || !state.seats[s].inHand) continue;
+                start.cards = state.seats[s].hole;
+                send(*t.players[s], start);
+            }
+        }
+    }
+
+    // Sends log entries added since the last call to everyone at the table.
+    void relayEvents(ServerTable& t) {
+        const ArenaList<HandEvent>& events = t.table->events();
+        if (events.size() == t.eventsSent) return;
+        size_t index = 0;
+        uint8_t frame[protocol::kMaxFrameBytes];
+        protocol::Message message;
+        message.type = protocol::MessageType::Event;
+        for (const HandEvent& e : events) {
+            if (index++ < t.eventsSent) continue;
+            message.event = e;
+            const size_t size = protocol::encode(message, frame);
+            for (int s = 0; s < config_.table.seats; ++s) {
+                if (t.players[s]) queue(*t.players[s], frame, size);
+            }
+        }
+        t.eventsSent = events.size();
+    }
+
+    void send(Connection& c, const protocol::Message& message) {
+        uint8_t frame[protocol::kMaxFrameBytes];
+        queue(c, frame, protocol::encode(message, frame));
+    }
+
+    void queue(Connection& c, const uint8_t* data, size_t size) {
+        if (c.closed || c.doomed) return;
+        if (!c.outTail || pool_.bufferBytes() - c.outTail->end < size) {
+            PooledBuffer* b = pool_.acquire();
+            (c.outTail ? c.outTail->next : c.outHead) = b;
+            c.outTail = b;
+        }
+        std::memcpy(c.outTail->data() + c.outTail->end, data, size);
+        c.outTail->end += static_cast<uint32_t>(size);
+        c.queued += size;
+        ++stats.messagesOut;
+        if (!c.dirty) {
+            c.dirty = true;
+            dirty_.push_back(&c);
+        }
+        if (c.queued > config_.maxQueuedBytes) {
+            c.doomed = true;
+            doomed_.push_back(&c);
+        }
+    }
+
+    void flush(Connection& c) {
+        c.dirty = false;
+        if (c.closed) return;
+        while (c.outHead) {
+            iovec iov[kMaxIovecs];
+            int count = 0;
+            for (PooledBuffer* b = c.outHead; b && count < kMaxIovecs; b = b->next) {
+                iov[count++] = {b->data() + b->begin, b->size()};
+            }
+            msghdr message{};
+            message.msg_iov = iov;
+            message.msg_iovlen = static_cast<size_t>(count);
+            ssize_t written = ::sendmsg(c.fd, &message, MSG_NOSIGNAL);
+            ++stats.writeCalls;
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                if (errno == EAGAIN) break;
+                close(c);
+                return;
+            }
+            stats.bytesOut += static_cast<uint64_t>(written);
+            c.queued -= static_cast<size_t>(written);
+            while (written > 0) {
+                PooledBuffer* b = c.outHead;
+                const size_t take = std::min(b->size(), static_cast<size_t>(written));
+                b->begin += static_cast<uint32_t>(take);
+                written -= static_cast<ssize_t>(take);
+                if (b->size() == 0) {
+                    c.outHead = b->next;
+                    pool_.release(b);
+                }
+            }
+            if (!c.outHead) c.outTail = nullptr;
+        }
+        // Wait for EPOLLOUT only while the socket is backed up.
+        const bool wantWrite = c.outHead != nullptr;
+        if (wantWrite != c.writeArmed) {
+            epoll_event ev{};
+            ev.events = EPOLLIN | EPOLLRDHUP | (wantWrite ? uint32_t{EPOLLOUT} : 0u);
+            ev.data.ptr = &c;
+            ::epoll_ctl(epollFd_, EPOLL_CTL_MOD, c.fd, &ev);
+            c.writeArmed = wantWrite;
+        }
+    }
+
+    void close(Connection& c) {
+        if (c.closed) return;
+        c.closed = true;
+        ::epoll_ctl(epollFd_, EPOLL_CTL_DEL, c.fd, nullptr);
+        ::close(c.fd);
+        ++stats.disconnected;
+        if (c.in) pool_.release(c.in);
+        while (c.outHead) {
+            PooledBuffer* next = c.outHead->next;
+            pool_.release(c.outHead);
+            c.outHead = next;
+        }
+        c.in = c.outTail = nullptr;
+        closed_.push_back(&c);
+        if (c.table >= 0) {
+            ServerTable& t = *tables_[c.table];
+            t.players[c.seat] = nullptr;
+            if (t.waitingSeat == c.seat) t.waitingSeat = -1;
+            drive(t);
+        }
+    }
+
+    const ServerConfig& config_;
+    unsigned index_;
+    int listenFd_;
+    int epollFd_ = -1;
+    int wakeFd_ = -1;
+    std::thread thread_;
+    BufferPool pool_;
+    std::vector<std::unique_ptr<Connection>> connections_;
+    std::vector<Connection*> free_;
+    std::vector<Connection*> dirty_;
+    std::vector<Connection*> doomed_;
+    std::vector<Connection*> closed_;   ///< recycled at the end of the batch
+    std::vector<std::unique_ptr<ServerTable>> tables_;
+    int64_t nextSweep_ = 0;
+};
+
+GameServer::GameServer(const ServerConfig& config) : config_(config) {
+    if (config_.threads < 1 || config_.table.seats < 2 || config_.table.seats > kMaxSeats ||
+        config_.bufferBytes < protocol::kMaxFrameBytes || config_.stack <= 0 ||
+        config_.actionTimeoutMs < 0) {
+        throw std::invalid_argument("GameServer: bad configuration");
+    }
+    port_ = config_.port;
+    for (unsigned i = 0; i < config_.threads; ++i) {
+        const int fd = listenSocket(config_.address, port_);
+        if (port_ == 0) port_ = boundPort(fd);
+        try {
+            loops_.push_back(std::make_unique<Loop>(config_, fd, i));
+        } catch (...) {
+            ::close(fd);
+            throw;
+        }
+    }
+}
+
+GameServer::~GameServer() { stop(); }
+
+void GameServer::start() {
+    if (running_) return;
+    for (auto& loop : loops_) loop->start();
+    running_ = true;
+}
+
+void GameServer::stop() {
+    if (!running_) return;
+    for (auto& loop : loops_) loop->stop();
+    running_ = false;
+}
+
+ServerStats GameServer::stats() const {
+    ServerStats total;
+    for (const auto& loop : loops_) {
+        const ServerStats& s = loop->stats;
+        total.accepted += s.accepted;
+        total.disconnected += s.disconnected;
+        total.hands += s.hands;
+        total.actions += s.actions;
+        total.illegalActions += s.illegalActions;
+        total.autoFolds += s.autoFolds;
+        total.timeouts += s.timeouts;
+        total.messagesIn += s.messagesIn;
+        total.messagesOut += s.messagesOut;
+        total.bytesIn += s.bytesIn;
+        total.bytesOut += s.bytesOut;
+        total.writeCalls += s.writeCalls;
+        total.tables += s.tables;
+        total.buffers += s.buffers;
+    }
+    return total;
+}
+
+size_t raiseOpenFileLimit(size_t wanted) {
+    rlimit limit;
+    if (::getrlimit(RLIMIT_NOFILE, &limit) != 0) return 0;
+    if (limit.rlim_cur < wanted) {
+        limit.rlim_cur = std::min<rlim_t>(wanted, limit.rlim_max);
+        ::setrlimit(RLIMIT_NOFILE, &limit);
+        ::getrlimit(RLIMIT_NOFILE, &limit);
+    }
+    return static_cast<size_t>(limit.rlim_cur);
+}
+
+} // namespace poker
@@ -0,0 +1,158 @@
+#include "poker/simulator.hpp"
+
+#include "poker/hand_history.hpp"
+#include "poker/profile.hpp"
+#include "poker/rng.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace poker {
+
+namespace {
+
+struct ShardResult {
+    ShardStats stats;
+    Chips net[kMaxSeats] = {};
+};
+
+void pinToCpu(std::thread& thread, unsigned cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu % CPU_SETSIZE, &set);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#else
+    (void)thread;
+    (void)cpu;
+#endif
+}
+
+// One shard: tables [first, last). Everything it touches is built here.
+void runShard(const SimulationConfig& config, const BotFactory& makeBot, int first, int last,
+              HandHistoryWriter* history, ShardResult& result) {
+    struct TableSlot {
+        std::unique_ptr<Table> table;
+        std::unique_ptr<Bot> bots[kMaxSeats];
+        Rng rng;
+    };
+    const int seats = config.table.seats;
+    std::vector<TableSlot> tables(last - first);
+    for (int i = first; i < last; ++i) {
+        TableSlot& t = tables[i - first];
+        t.table = std::make_unique<Table>(config.table);
+        for (int s = 0; s < seats; ++s) t.bots[s] = makeBot(s);
+        t.rng = Rng::forStream(config.seed, static_cast<uint64_t>(i));
+    }
+
+    ShardStats stats;
+    stats.tables = last - first;
+    Chips net[kMaxSeats] = {};
+    const auto start = std::chrono::steady_clock::now();
+    POKER_PROFILE_SCOPE(SimulationShard);
+    for (int i = first; i < last; ++i) {
+        TableSlot& t = tables[i - first];
+        Table& table = *t.table;
+        for (uint64_t h = 0; h < config.handsPerTable; ++h) {
+            for (int s = 0; s < seats; ++s) table.seatPlayer(s, config.stack);
+            table.startHand(t.rng);
+            while (table.handInProgress()) {
+                const int seat = table.toAct();
+                const LegalActions legal = table.legalActions();
+                Action action = t.bots[seat]->act(table, seat, legal, t.rng);
+                if (!legal.allows(action)) {
+                    action = legal.canCheck ? Action::check() : Action::fold();
+                    ++stats.illegalActions;
+                }
+                table.act(action);
+                ++stats.actions;
+            }
+            for (int s = 0; s < seats; ++s) net[s] += table.state().seats[s].stack - config.stack;
+            if (history && !history->append(table, static_cast<uint32_t>(i))) {
+                ++stats.historyErrors;
+                history = nullptr;  // the file ends at the last hand written
+            }
+        }
+        stats.hands += config.handsPerTable;
+    }
+    if (history && !history->flush()) ++stats.historyErrors;
+    stats.seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    result.stats = stats;
+    std::copy(net, net + kMaxSeats, result.net);
+}
+
+} // namespace
+
+double SimulationReport::handsPerSecondPerCore() const {
+    if (shards.empty()) return 0;
+    double sum = 0;
+    for (const ShardStats& s : shards) sum += s.handsPerSecond();
+    return sum / shards.size();
+}
+
+SimulationReport runSimulation(const SimulationConfig& config, const BotFactory& makeBot) {
+    if (config.tables <= 0) throw std::invalid_argument("simulation needs at least one table");
+    if (config.table.seats < 2 || config.table.seats > kMaxSeats) {
+        throw std::invalid_argument("table seats must be between 2 and 10");
+    }
+    if (config.stack <= 0) throw std::invalid_argument("starting stack must be positive");
+    if (!makeBot) throw std::invalid_argument("simulation needs a bot factory");
+
+    unsigned threads = config.threads ? config.threads : std::thread::hardware_concurrency();
+    threads = std::clamp(threads, 1u, static_cast<unsigned>(config.tables));
+
+    // Separate heap blocks keep one shard's result off another's cache lines.
+    std::vector<std::unique_ptr<ShardResult>> results(threads);
+    for (auto& r : results) r = std::make_unique<ShardResult>();
+    // Opened here so a bad path throws to the caller rather than in a worker.
+    std::vector<std::unique_ptr<HandHistoryWriter>> histories(threads);
+    if (!config.historyPath.empty()) {
+        for (unsigned t = 0; t < threads; ++t) {
+            histories[t] = std::make_unique<HandHistoryWriter>(config.historyPath + "." +
+                                                               std::to_string(t));
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    auto bounds = [&](unsigned t) {
+        return static_cast<int>(static_cast<uint64_t>(config.tables) * t / threads);
+    };
+    // The calling thread runs shard 0 itself unless threads are pinned, in
+    // which case it only waits, so its own affinity is left alone.
+    const unsigned firstSpawned = config.pinThreads ? 0 : 1;
+    for (unsigned t = firstSpawned; t < threads; ++t) {
+        workers.emplace_back(runShard, std::cref(config), std::cref(makeBot), bounds(t),
+                             bounds(t + 1), histories[t].get(), std::ref(*results[t]));
+        if (config.pinThreads) pinToCpu(workers.back(), t);
+    }
+    if (firstSpawned == 1) {
+        runShard(config, makeBot, bounds(0), bounds(1), histories[0].get(), *results[0]);
+    }
+    for (std::thread& w : workers) w.join();
+
+    SimulationReport report;
+    report.seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (const auto& r : results) {
+        report.shards.push_back(r->stats);
+        report.hands += r->stats.hands;
+        report.actions += r->stats.actions;
+        report.illegalActions += r->stats.illegalActions;
+        report.historyErrors += r->stats.historyErrors;
+        for (int s = 0; s < kMaxSeats; ++s) report.net[s] += r->net[s];
+    }
+    return report;
+}
+
+} // namespace poker
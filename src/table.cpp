@@ -0,0 +1,426 @@
+#include "poker/table.hpp"
+
+#include "poker/profile.hpp"
+#include "poker/rng.hpp"
+
+#include <algorithm>
+
+namespace poker {
+
+namespace {
+
+constexpr uint16_t bit(int seat) { return static_cast<uint16_t>(1u << seat); }
+
+bool isLive(const SeatState& s) { return s.inHand && !s.folded; }
+bool canStillBet(const SeatState& s) { return s.inHand && !s.folded && !s.allIn; }
+bool canBeDealt(const SeatState& s) { return s.occupied && s.stack > 0; }
+
+} // namespace
+
+int HandState::playersInHand() const {
+    int count = 0;
+    for (const SeatState& s : seats) count += isLive(s);
+    return count;
+}
+
+Chips HandState::totalPot() const {
+    Chips total = 0;
+    for (const SeatState& s : seats) total += s.handCommitted;
+    return total;
+}
+
+template <class Variant>
+BasicTable<Variant>::BasicTable(const TableConfig& config)
+    : config_(config), arena_(config.arenaBytes), events_(arena_) {
+    config_.seats = std::clamp(config_.seats, 2, kMaxSeats);
+}
+
+template <class Variant>
+void BasicTable<Variant>::seatPlayer(int seat, Chips stack) {
+    if (seat < 0 || seat >= config_.seats || handInProgress()) return;
+    state_.seats[seat].occupied = true;
+    state_.seats[seat].stack = stack;
+}
+
+template <class Variant>
+void BasicTable<Variant>::removePlayer(int seat) {
+    if (seat < 0 || seat >= config_.seats || handInProgress()) return;
+    state_.seats[seat] = SeatState();
+}
+
+template <class Variant>
+uint16_t BasicTable<Variant>::seatsWhere(bool (*pred)(const SeatState&)) const {
+    uint16_t mask = 0;
+    for (int s = 0; s < config_.seats; ++s) {
+        if (pred(state_.seats[s])) mask |= bit(s);
+    }
+    return mask;
+}
+
+template <class Variant>
+int BasicTable<Variant>::nextSeat(int from, uint16_t mask) const {
+    for (int i = 1; i <= config_.seats; ++i) {
+        const int seat = (from + i) % config_.seats;
+        if (mask & bit(seat)) return seat;
+    }
+    return -1;
+}
+
+template <class Variant>
+void BasicTable<Variant>::log(EventType type, int seat, Chips amount, bool allIn, int pot) {
+    events_.push({amount, static_cast<int8_t>(seat), type, state_.street,
+                  static_cast<uint8_t>(allIn), static_cast<uint8_t>(pot)});
+}
+
+template <class Variant>
+void BasicTable<Variant>::commit(int seat, Chips amount) {
+    SeatState& s = state_.seats[seat];
+    amount = std::min(amount, s.stack);
+    s.stack -= amount;
+    s.streetCommitted += amount;
+    s.handCommitted += amount;
+    if (s.stack == 0) s.allIn = true;
+}
+
+template <class Variant>
+bool BasicTable<Variant>::startHand(Rng& rng) {
+    POKER_PROFILE_SCOPE(TableStartHand);
+    if (handInProgress()) return false;
+    const uint16_t dealt = seatsWhere(canBeDealt);
+    if (__builtin_popcount(dealt) < 2) return false;
+
+    arena_.reset();
+    events_.clear();
+
+    HandState& st = state_;
+    const int previousButton = st.button < 0 ? config_.seats - 1 : st.button;
+    for (int seat = 0; seat < kMaxSeats; ++seat) {
+        SeatState& s = st.seats[seat];
+        const SeatState kept = s;
+        s = SeatState();
+        s.occupied = kept.occupied;
+        s.stack = kept.stack;
+        s.startingStack = kept.stack;
+        s.inHand = (dealt & bit(seat)) != 0;
+    }
+    ++st.handNumber;
+    st.potCount = 0;
+    st.board = CardSet();
+    st.street = Street::Preflop;
+    st.complete = false;
+
+    st.button = static_cast<int8_t>(nextSeat(previousButton, dealt));
+    if (__builtin_popcount(dealt) == 2) {
+        st.smallBlindSeat = st.button;
+    } else {
+        st.smallBlindSeat = static_cast<int8_t>(nextSeat(st.button, dealt));
+    }
+    st.bigBlindSeat = static_cast<int8_t>(nextSeat(st.smallBlindSeat, dealt));
+
+    deck_.reset(~CardSet(Variant::kDeckBits));
+    for (int seat = st.smallBlindSeat, n = 0; n < __builtin_popcount(dealt);
+         seat = nextSeat(seat, dealt), ++n) {
+        st.seats[seat].hole = deck_.deal(rng, Variant::kHoleCards);
+    }
+    for (Card& card : runout_) card = deck_.deal(rng);
+
+    if (config_.ante > 0) {
+        for (int seat = 0; seat < config_.seats; ++seat) {
+            if (!(dealt & bit(seat))) continue;
+            const Chips before = st.seats[seat].stack;
+            commit(seat, config_.ante);
+            const Chips posted = before - st.seats[seat].stack;
+            st.seats[seat].streetCommitted -= posted;  // antes are dead money
+            log(EventType::PostAnte, seat, posted, st.seats[seat].allIn);
+        }
+    }
+    const auto postBlind = [&](int seat, Chips blind, EventType type) {
+        const Chips before = st.seats[seat].stack;
+        commit(seat, blind);
+        log(type, seat, before - st.seats[seat].stack, st.seats[seat].allIn);
+    };
+    postBlind(st.smallBlindSeat, config_.smallBlind, EventType::PostSmallBlind);
+    postBlind(st.bigBlindSeat, config_.bigBlind, EventType::PostBigBlind);
+
+    st.currentBet = std::max(st.seats[st.smallBlindSeat].streetCommitted,
+                             st.seats[st.bigBlindSeat].streetCommitted);
+    st.lastRaiseSize = config_.bigBlind;
+    st.actedSinceFullRaise = 0;
+
+    const uint16_t bettors = seatsWhere(canStillBet);
+    st.pending = bettors;
+    if (__builtin_popcount(bettors) < 2) {
+        // Nobody left to bet against: only a player facing a bet must act.
+        st.pending = 0;
+        for (int seat = 0; seat < config_.seats; ++seat) {
+            if ((bettors & bit(seat)) && st.seats[seat].streetCommitted < st.currentBet) {
+                st.pending |= bit(seat);
+            }
+        }
+    }
+    if (st.pending == 0) {
+        endStreet();
+    } else {
+        st.toAct = static_cast<int8_t>(nextSeat(st.bigBlindSeat, st.pending));
+    }
+    POKER_PROFILE_COUNT(HandsDealt, 1);
+    return true;
+}
+
+template <class Variant>
+LegalActions BasicTable<Variant>::legalActions() const {
+    LegalActions legal;
+    const int seat = state_.toAct;
+    if (seat < 0) return legal;
+    const SeatState& s = state_.seats[seat];
+    legal.canCheck = s.streetCommitted >= state_.currentBet;
+    legal.toCall = std::min(state_.currentBet - s.streetCommitted, s.stack);
+    if (legal.toCall < 0) legal.toCall = 0;
+    legal.maxRaiseTo = s.streetCommitted + s.stack;
+    legal.minRaiseTo = std::min(state_.currentBet + state_.lastRaiseSize, legal.maxRaiseTo);
+    const bool opponentsCanAct = (seatsWhere(canStillBet) & ~bit(seat)) != 0;
+    legal.canRaise = !(state_.actedSinceFullRaise & bit(seat)) &&
+                     legal.maxRaiseTo > state_.currentBet && opponentsCanAct;
+    return legal;
+}
+
+template <class Variant>
+bool BasicTable<Variant>::act(const Action& action) {
+    POKER_PROFILE_SCOPE(TableAct);
+    if (!handInProgress() || state_.toAct < 0) return false;
+    const int seat = state_.toAct;
+    const LegalActions legal = legalActions();
+    HandState& st = state_;
+    SeatState& s = st.seats[seat];
+
+    switch (action.type) {
+    case Action::Fold:
+        s.folded = true;
+        st.pending &= ~bit(seat);
+        log(EventType::Fold, seat, 0);
+        break;
+    case Action::Check:
+        if (!legal.canCheck) return false;
+        st.pending &= ~bit(seat);
+        st.actedSinceFullRaise |= bit(seat);
+        log(EventType::Check, seat, 0);
+        break;
+    case Action::Call:
+        if (legal.canCheck) return false;
+        commit(seat, legal.toCall);
+        st.pending &= ~bit(seat);
+        st.actedSinceFullRaise |= bit(seat);
+        log(EventType::Call, seat, legal.toCall, s.allIn);
+        break;
+    case Action::Bet:
+    case Action::Raise: {
+        const Chips to = action.amount;
+        if (!legal.canRaise || to > legal.maxRaiseTo) return false;
+        if (to < legal.minRaiseTo || to <= st.currentBet) return false;
+        const EventType type = st.currentBet == 0 ? EventType::Bet : EventType::Raise;
+        const Chips raiseSize = to - st.currentBet;
+        commit(seat, to - s.streetCommitted);
+        log(type, seat, to, s.allIn);
+        const uint16_t bettors = seatsWhere(canStillBet) & ~bit(seat);
+        if (raiseSize >= st.lastRaiseSize) {
+            // A full raise reopens the betting for everyone.
+            st.lastRaiseSize = raiseSize;
+            st.actedSinceFullRaise = bit(seat);
+            st.pending = bettors;
+        } else {
+            // A short all-in must be answered but lets nobody who already
+            // acted raise again.
+            st.actedSinceFullRaise |= bit(seat);
+            for (int other = 0; other < config_.seats; ++other) {
+                if ((bettors & bit(other)) && st.seats[other].streetCommitted < to) {
+                    st.pending |= bit(other);
+                }
+            }
+            st.pending &= ~bit(seat);
+        }
+        st.currentBet = to;
+        break;
+    }
+    default:
+        return false;
+    }
+    afterAction(seat);
+    POKER_PROFILE_COUNT(Actions, 1);
+    return true;
+}
+
+template <class Variant>
+void BasicTable<Variant>::afterAction(int seat) {
+    HandState& st = state_;
+    if (st.playersInHand() == 1) {
+        finishHand();
+        return;
+    }
+    st.pending &= seatsWhere(canStillBet);
+    if (st.pending == 0) {
+        endStreet();
+    } else {
+        st.toAct = static_cast<int8_t>(nextSeat(seat, st.pending));
+    }
+}
+
+template <class Variant>
+void BasicTable<Variant>::startStreet(Street street) {
+    HandState& st = state_;
+    st.street = street;
+    switch (street) {
+    case Street::Flop:
+        st.board = CardSet(runout_[0]) | CardSet(runout_[1]) | CardSet(runout_[2]);
+        log(EventType::DealFlop, -1, 0);
+        break;
+    case Street::Turn:
+        st.board.add(runout_[3]);
+        log(EventType::DealTurn, -1, 0);
+        break;
+    case Street::River:
+        st.board.add(runout_[4]);
+        log(EventType::DealRiver, -1, 0);
+        break;
+    default:
+        break;
+    }
+    for (int seat = 0; seat < config_.seats; ++seat) st.seats[seat].streetCommitted = 0;
+    st.currentBet = 0;
+    st.lastRaiseSize = config_.bigBlind;
+    st.actedSinceFullRaise = 0;
+    st.pending = seatsWhere(canStillBet);
+}
+
+template <class Variant>
+void BasicTable<Variant>::endStreet() {
+    HandState& st = state_;
+    // With at most one player able to bet, the rest of the board is dealt out.
+    const bool runOut = __builtin_popcount(seatsWhere(canStillBet)) < 2;
+    while (st.street != Street::River) {
+        startStreet(static_cast<Street>(static_cast<int>(st.street) + 1));
+        if (!runOut) {
+            st.toAct = static_cast<int8_t>(nextSeat(st.button, st.pending));
+            return;
+        }
+    }
+    st.street = Street::Showdown;
+    finishHand();
+}
+
+template <class Variant>
+void BasicTable<Variant>::returnUncalled() {
+    HandState& st = state_;
+    int top = -1;
+    for (int seat = 0; seat < config_.seats; ++seat) {
+        if (!st.seats[seat].inHand) continue;
+        if (top < 0 || st.seats[seat].handCommitted > st.seats[top].handCommitted) top = seat;
+    }
+    if (top < 0) return;
+    Chips second = 0;
+    for (int seat = 0; seat < config_.seats; ++seat) {
+        if (seat != top && st.seats[seat].inHand) second = std::max(second, st.seats[seat].handCommitted);
+    }
+    SeatState& s = st.seats[top];
+    const Chips excess = s.handCommitted - second;
+    if (excess <= 0) return;
+    s.handCommitted -= excess;
+    s.streetCommitted = std::max<Chips>(0, s.streetCommitted - excess);
+    s.stack += excess;
+    s.allIn = s.stack == 0;
+    log(EventType::ReturnUncalled, top, excess);
+}
+
+template <class Variant>
+void BasicTable<Variant>::buildPots() {
+    HandState& st = state_;
+    // Distinct commitments of the live players, ascending; each one caps a pot.
+    Chips levels[kMaxSeats];
+    int levelCount = 0;
+    for (int seat = 0; seat < config_.seats; ++seat) {
+        if (!isLive(st.seats[seat])) continue;
+        const Chips level = st.seats[seat].handCommitted;
+        int i = levelCount;
+        while (i > 0 && levels[i - 1] > level) --i;
+        if (i > 0 && levels[i - 1] == level) continue;
+        for (int j = levelCount; j > i; --j) levels[j] = levels[j - 1];
+        levels[i] = level;
+        ++levelCount;
+    }
+
+    st.potCount = 0;
+    Chips previous = 0;
+    for (int i = 0; i < levelCount; ++i) {
+        PotState pot;
+        for (int seat = 0; seat < config_.seats; ++seat) {
+            const SeatState& s = st.seats[seat];
+            if (!s.inHand) continue;
+            pot.amount += std::min(s.handCommitted, levels[i]) - std::min(s.handCommitted, previous);
+            if (isLive(s) && s.handCommitted >= levels[i]) pot.eligible |= bit(seat);
+        }
+        if (pot.amount > 0) st.pots[st.potCount++] = pot;
+        previous = levels[i];
+    }
+    // Dead money above the deepest live player (not reachable after uncalled
+    // chips are returned, but never lose chips).
+    for (int seat = 0; seat < config_.seats && st.potCount > 0; ++seat) {
+        const Chips c = st.seats[seat].handCommitted;
+        if (st.seats[seat].inHand && c > previous) st.pots[st.potCount - 1].amount += c - previous;
+    }
+}
+
+template <class Variant>
+void BasicTable<Variant>::awardPots() {
+    HandState& st = state_;
+    const uint16_t live = seatsWhere(isLive);
+    if (__builtin_popcount(live) > 1) {
+        for (int seat = 0; seat < config_.seats; ++seat) {
+            if (!(live & bit(seat))) continue;
+            st.seats[seat].showdownValue = showdownValue<Variant>(st.seats[seat].hole, st.board);
+            log(EventType::Show, seat, 0);
+        }
+    }
+    for (int p = 0; p < st.potCount; ++p) {
+        const PotState& pot = st.pots[p];
+        HandValue best = 0;
+        uint16_t winners = 0;
+        for (int seat = 0; seat < config_.seats; ++seat) {
+            if (!(pot.eligible & bit(seat))) continue;
+            const HandValue v = st.seats[seat].showdownValue;
+            if (winners == 0 || v > best) {
+                best = v;
+                winners = bit(seat);
+            } else if (v == best) {
+                winners |= bit(seat);
+            }
+        }
+        const int count = __builtin_popcount(winners);
+        const Chips share = pot.amount / count;
+        Chips oddChips = pot.amount % count;
+        // Odd chips go to the winners closest to the left of the button.
+        for (int seat = nextSeat(st.button, winners), n = 0; n < count;
+             seat = nextSeat(seat, winners), ++n) {
+            const Chips amount = share + (oddChips > 0 ? 1 : 0);
+            if (oddChips > 0) --oddChips;
+            st.seats[seat].won += amount;
+            log(EventType::WinPot, seat, amount, false, p);
+        }
+    }
+    for (int seat = 0; seat < config_.seats; ++seat) st.seats[seat].stack += st.seats[seat].won;
+}
+
+template <class Variant>
+void BasicTable<Variant>::finishHand() {
+    HandState& st = state_;
+    returnUncalled();
+    buildPots();
+    awardPots();
+    st.pending = 0;
+    st.toAct = -1;
+    st.complete = true;
+}
+
+template class BasicTable<Holdem>;
+template class BasicTable<ShortDeck>;
+template class BasicTable<Omaha>;
+
+} // namespace poker
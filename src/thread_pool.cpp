@@ -0,0 +1,104 @@
+#include "poker/thread_pool.hpp"
+
+namespace poker {
+
+ThreadPool::ThreadPool(unsigned threads) {
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    workerCount_ = threads == 0 ? 1 : threads;
+    blocks_ = std::make_unique<Block[]>(workerCount_);
+    threads_.reserve(workerCount_ - 1);
+    for (unsigned w = 1; w < workerCount_; ++w) {
+        threads_.emplace_back([this, w] { workerLoop(w); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& t : threads_) t.join();
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::run(size_t count, TaskFn fn, void* ctx) {
+    if (count == 0) return;
+    std::lock_guard<std::mutex> serial(runMutex_);
+    for (unsigned w = 0; w < workerCount_; ++w) {
+        std::lock_guard<std::mutex> guard(blocks_[w].lock);
+        blocks_[w].begin = count * w / workerCount_;
+        blocks_[w].end = count * (w + 1) / workerCount_;
+    }
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        fn_ = fn;
+        ctx_ = ctx;
+        busy_ = workerCount_ - 1;
+        ++generation_;
+    }
+    wake_.notify_all();
+    work(0);
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return busy_ == 0; });
+}
+
+void ThreadPool::workerLoop(unsigned worker) {
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+            if (stopping_) return;
+            seen = generation_;
+        }
+        work(worker);
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (--busy_ == 0) done_.notify_one();
+    }
+}
+
+void ThreadPool::work(unsigned worker) {
+    size_t task;
+    for (;;) {
+        while (take(worker, task)) fn_(ctx_, task, worker);
+        if (!steal(worker)) return;
+    }
+}
+
+bool ThreadPool::take(unsigned worker, size_t& task) {
+    Block& block = blocks_[worker];
+    std::lock_guard<std::mutex> guard(block.lock);
+    if (block.begin == block.end) return false;
+    task = block.begin++;
+    return true;
+}
+
+bool ThreadPool::steal(unsigned thief) {
+    // A range in transit to another thief is invisible here, but that thief
+    // runs it, so finding every block empty still means this worker is done.
+    for (unsigned i = 1; i < workerCount_; ++i) {
+        Block& victim = blocks_[(thief + i) % workerCount_];
+        size_t begin, end;
+        {
+            std::lock_guard<std::mutex> guard(victim.lock);
+            const size_t remaining = victim.end - victim.begin;
+            if (remaining == 0) continue;
+            end = victim.end;
+            begin = victim.end - (remaining + 1) / 2;
+            victim.end = begin;
+        }
+        Block& own = blocks_[thief];
+        std::lock_guard<std::mutex> guard(own.lock);
+        own.begin = begin;
+        own.end = end;
+        return true;
+    }
+    return false;
+}
+
+} // namespace poker
@@ -0,0 +1,126 @@
+// Offline card-abstraction builder.
+//
+// Usage: build_abstraction <output-path> [key=value ...]
+//
+//   streets=preflop,flop,turn,river   streets to bucket (default: all)
+//   buckets=169,200,200,200           clusters per street
+//   rollouts=1024,32,16,1             board completions per hand
+//   samples=0,32,32,64                opponent hands per board (0 = all)
+//   bins=16  fit=1000000  iterations=25  seed=<n>  threads=<n>
+//
+// Per-street lists give values for preflop, flop, ... in order, leaving
+// later streets at their defaults; a single value applies to every street.
+// Prints one key=value line per street. The river enumerates about 123M
+// hands and writes a ~2.7 GB map, so expect it to run for a long time.
+
+#include "poker/abstraction.hpp"
+#include "poker/thread_pool.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <string>
+
+using namespace poker;
+
+namespace {
+
+const char* const kStreetNames[kNumStreets] = {"preflop", "flop", "turn", "river"};
+
+// Parses "a,b,..." (or one value for all streets) into `out`. Returns how
+// many streets it sets, 0 on malformed input.
+int parseList(const std::string& text, long long out[kNumStreets]) {
+    size_t start = 0;
+    int count = 0;
+    for (;;) {
+        if (count == kNumStreets) return 0;
+        const size_t comma = text.find(',', start);
+        const std::string item = text.substr(start, comma - start);
+        char* end = nullptr;
+        out[count++] = std::strtoll(item.c_str(), &end, 10);
+        if (item.empty() || *end != '\0') return 0;
+        if (comma == std::string::npos) break;
+        start = comma + 1;
+    }
+    if (count > 1) return count;
+    for (int s = 1; s < kNumStreets; ++s) out[s] = out[0];
+    return kNumStreets;
+}
+
+bool apply(AbstractionConfig& config, unsigned& threads, const std::string& key, const std::string& value) {
+    long long values[kNumStreets];
+    if (key == "streets") {
+        for (StreetAbstractionConfig& s : config.streets) s.enabled = false;
+        size_t start = 0;
+        while (start <= value.size()) {
+            const size_t comma = value.find(',', start);
+            const std::string name = value.substr(start, comma - start);
+            bool known = false;
+            for (int s = 0; s < kNumStreets; ++s) {
+                if (name == kStreetNames[s]) config.streets[s].enabled = known = true;
+            }
+            if (!known) return false;
+            if (comma == std::string::npos) break;
+            start = comma + 1;
+        }
+        return true;
+    }
+    if (key == "seed") {
+        config.seed = std::strtoull(value.c_str(), nullptr, 0);
+        return true;
+    }
+    if (key == "threads") {
+        threads = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+        return true;
+    }
+    const int count = parseList(value, values);
+    if (count == 0) return false;
+    for (int s = 0; s < count; ++s) {
+        StreetAbstractionConfig& street = config.streets[s];
+        if (key == "buckets") street.buckets = static_cast<int>(values[s]);
+        else if (key == "rollouts") street.rollouts = static_cast<int>(values[s]);
+        else if (key == "samples") street.opponentSamples = static_cast<int>(values[s]);
+        else if (key == "bins") street.bins = static_cast<int>(values[s]);
+        else if (key == "fit") street.fitHands = static_cast<size_t>(values[s]);
+        else if (key == "iterations") street.iterations = static_cast<int>(values[s]);
+        else return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s <output-path> [key=value ...]\n", argv[0]);
+        return 2;
+    }
+    AbstractionConfig config;
+    unsigned threads = 0;
+    for (int i = 2; i < argc; ++i) {
+        const char* eq = std::strchr(argv[i], '=');
+        if (!eq || !apply(config, threads, std::string(argv[i], eq - argv[i]), eq + 1)) {
+            std::fprintf(stderr, "bad argument: %s\n", argv[i]);
+            return 2;
+        }
+    }
+    ThreadPool pool(threads);
+    config.pool = &pool;
+
+    try {
+        const AbstractionReport report = buildAbstraction(config, argv[1]);
+        for (int s = 0; s < kNumStreets; ++s) {
+            if (!config.streets[s].enabled) continue;
+            const StreetAbstractionReport& r = report.streets[s];
+            std::printf("street=%s hands=%zu buckets=%d iterations=%d inertia=%.6f seconds=%.3f\n",
+                        kStreetNames[s], r.hands, r.buckets, r.iterations, r.inertia, r.seconds);
+        }
+        std::printf("file=%s bytes=%zu\n", argv[1], report.fileBytes);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
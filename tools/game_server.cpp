@@ -0,0 +1,79 @@
+// Standalone game server.
+//
+// Usage: game_server [key=value ...]
+//
+//   address=127.0.0.1  port=7777  threads=1  seats=6  stack=200  seed=<n>
+//   timeout=30000      milliseconds to answer an action request (0 = forever)
+//
+// Serves until SIGINT or SIGTERM, then prints the server counters as one
+// key=value line. Drive it with load_client.
+
+#include "poker/server.hpp"
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string>
+
+#include <pthread.h>
+
+using namespace poker;
+
+int main(int argc, char** argv) {
+    ServerConfig config;
+    config.port = 7777;
+    for (int i = 1; i < argc; ++i) {
+        const char* eq = std::strchr(argv[i], '=');
+        const std::string key = eq ? std::string(argv[i], eq - argv[i]) : argv[i];
+        const char* value = eq ? eq + 1 : "";
+        if (key == "address") config.address = value;
+        else if (key == "port") config.port = static_cast<uint16_t>(std::atoi(value));
+        else if (key == "threads") config.threads = static_cast<unsigned>(std::atoi(value));
+        else if (key == "seats") config.table.seats = std::atoi(value);
+        else if (key == "stack") config.stack = std::atoll(value);
+        else if (key == "seed") config.seed = std::strtoull(value, nullptr, 0);
+        else if (key == "timeout") config.actionTimeoutMs = std::atoi(value);
+        else {
+            std::fprintf(stderr, "bad argument: %s\n", argv[i]);
+            return 2;
+        }
+    }
+    raiseOpenFileLimit(1 << 20);
+
+    // Block the stop signals before the loop threads start so only sigwait()
+    // below sees them.
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    try {
+        GameServer server(config);
+        server.start();
+        std::printf("listening address=%s port=%u threads=%u\n", config.address.c_str(), server.port(),
+                    config.threads);
+        std::fflush(stdout);
+        int signal = 0;
+        sigwait(&signals, &signal);
+        server.stop();
+        const ServerStats s = server.stats();
+        std::printf("accepted=%llu hands=%llu actions=%llu illegal=%llu timeouts=%llu tables=%llu "
+                    "messages_in=%llu messages_out=%llu writes=%llu bytes_out=%llu\n",
+                    static_cast<unsigned long long>(s.accepted), static_cast<unsigned long long>(s.hands),
+                    static_cast<unsigned long long>(s.actions),
+                    static_cast<unsigned long long>(s.illegalActions),
+                    static_cast<unsigned long long>(s.timeouts),
+                    static_cast<unsigned long long>(s.tables),
+                    static_cast<unsigned long long>(s.messagesIn),
+                    static_cast<unsigned long long>(s.messagesOut),
+                    static_cast<unsigned long long>(s.writeCalls),
+                    static_cast<unsigned long long>(s.bytesOut));
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
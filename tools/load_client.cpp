@@ -0,0 +1,52 @@
+// Load generator for game_server.
+//
+// Usage: load_client [key=value ...]
+//
+//   address=127.0.0.1  port=7777  connections=1000  threads=1  seconds=5
+//
+// Prints action latency percentiles and throughput as one key=value line.
+
+#include "poker/load_client.hpp"
+#include "poker/server.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string>
+
+using namespace poker;
+
+int main(int argc, char** argv) {
+    LoadClientConfig config;
+    config.port = 7777;
+    for (int i = 1; i < argc; ++i) {
+        const char* eq = std::strchr(argv[i], '=');
+        const std::string key = eq ? std::string(argv[i], eq - argv[i]) : argv[i];
+        const char* value = eq ? eq + 1 : "";
+        if (key == "address") config.address = value;
+        else if (key == "port") config.port = static_cast<uint16_t>(std::atoi(value));
+        else if (key == "connections") config.connections = std::atoi(value);
+        else if (key == "threads") config.threads = static_cast<unsigned>(std::atoi(value));
+        else if (key == "seconds") config.seconds = std::atof(value);
+        else if (key == "seed") config.seed = std::strtoull(value, nullptr, 0);
+        else {
+            std::fprintf(stderr, "bad argument: %s\n", argv[i]);
+            return 2;
+        }
+    }
+    raiseOpenFileLimit(static_cast<size_t>(config.connections) + 64);
+
+    try {
+        const LoadReport r = runLoadClient(config);
+        std::printf("connected=%d actions=%llu seconds=%.3f actions_per_sec=%.0f hands=%llu "
+                    "p50_us=%.1f p99_us=%.1f p999_us=%.1f max_us=%.1f errors=%llu\n",
+                    r.connected, static_cast<unsigned long long>(r.actions), r.seconds,
+                    r.actionsPerSecond(), static_cast<unsigned long long>(r.hands), r.p50Micros,
+                    r.p99Micros, r.p999Micros, r.maxMicros, static_cast<unsigned long long>(r.errors));
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}